@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rotaryencoder/batch.h>
+
+enum
+{
+  WORDS = 1 << 14,
+  ROUNDS = 64
+};
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* random walk, holding each gray code position for `hold` samples */
+static void make_samples(uint64_t* samples, size_t words, int hold)
+{
+  static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+  unsigned pos = 0;
+  int left = 0;
+
+  for (size_t i = 0; i < words; ++i)
+  {
+    uint64_t w = 0;
+
+    for (unsigned k = 0; k < 64; k += 2)
+    {
+      if (left-- <= 0)
+      {
+        pos += rand() % 4 == 0 ? -1 : 1;
+        left = hold - 1;
+      }
+
+      w |= (uint64_t)gray[pos % 4] << k;
+    }
+
+    samples[i] = w;
+  }
+}
+
+static double run(enum encoder_batch_isa isa, uint64_t const* samples,
+                  uint64_t* actions, encoder_position_t* delta)
+{
+  encoder_state es;
+  double t0;
+
+  encoder_batch_select_isa(isa);
+  encoder_debounced_full_step_init(&es, 0x3);
+  *delta = 0;
+
+  t0 = now();
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    *delta += encoder_debounced_full_step_update_batch(&es, samples, actions,
+                                                       WORDS);
+  }
+
+  return (double)WORDS * 32 * ROUNDS / (now() - t0);
+}
+
+int main(void)
+{
+  static int const holds[] = {1, 2, 4, 16, 64};
+  uint64_t* samples = malloc(WORDS * sizeof(uint64_t));
+  uint64_t* actions = malloc(WORDS * sizeof(uint64_t));
+
+  printf("%6s %16s %16s %8s\n", "hold", "generic [MS/s]", "bmi2 [MS/s]",
+         "speedup");
+
+  for (size_t h = 0; h < sizeof(holds) / sizeof(holds[0]); ++h)
+  {
+    encoder_position_t d_generic, d_bmi2 = 0;
+    double generic, bmi2 = 0.0;
+
+    make_samples(samples, WORDS, holds[h]);
+
+    generic = run(ENCODER_BATCH_ISA_GENERIC, samples, actions, &d_generic);
+
+    if (encoder_batch_isa_supported(ENCODER_BATCH_ISA_BMI2))
+    {
+      bmi2 = run(ENCODER_BATCH_ISA_BMI2, samples, actions, &d_bmi2);
+
+      if (d_bmi2 != d_generic)
+      {
+        fprintf(stderr, "result mismatch: %ld != %ld\n", d_bmi2, d_generic);
+        return 1;
+      }
+    }
+
+    printf("%6d %16.1f %16.1f %7.2fx\n", holds[h], generic * 1e-6,
+           bmi2 * 1e-6, bmi2 / generic);
+  }
+
+  free(samples);
+  free(actions);
+
+  return 0;
+}
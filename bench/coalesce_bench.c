@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rotaryencoder/coalesce.h>
+
+enum
+{
+  ENCODERS = 16,
+  ACTIONS = 1 << 24
+};
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+struct run
+{
+  encoder_coalescer* c;
+  encoder_position_t total;
+  atomic_int done;
+};
+
+/* encoders spinning as fast as the producer can decode them */
+static void* produce(void* arg)
+{
+  struct run* r = arg;
+  unsigned seed = 42;
+  uint64_t now = now_ns();
+
+  for (size_t k = 0; k < ACTIONS; ++k)
+  {
+    encoder_position_t const delta = rand_r(&seed) % 8 ? 1 : -1;
+
+    if (k % 256 == 0)
+    {
+      now = now_ns();
+      encoder_coalescer_poll(r->c, now);
+    }
+
+    encoder_coalescer_add(r->c, k % ENCODERS, delta, now);
+    r->total += delta;
+  }
+
+  encoder_coalescer_flush(r->c);
+  atomic_store(&r->done, 1);
+
+  return NULL;
+}
+
+int main(void)
+{
+  static struct
+  {
+    char const* name;
+    uint64_t latency;
+    unsigned long threshold;
+  } const configs[] = {
+      {"none", 0, 1},
+      {"100us", 100000, 1000000},
+      {"2ms", 2000000, 1000000},
+      {"2ms/1000", 2000000, 1000},
+  };
+
+  printf("%-10s %14s %12s %16s %12s\n", "coalesce", "actions [M/s]",
+         "handoffs", "actions/handoff", "drains");
+
+  for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); ++i)
+  {
+    static struct run r;
+    encoder_position_t deltas[ENCODERS] = {0};
+    encoder_position_t sum = 0;
+    struct timespec const frame = {0, 8000000};
+    unsigned long drains = 0;
+    pthread_t thread;
+    uint64_t t0;
+    int done;
+
+    r.c = encoder_coalescer_create(ENCODERS, configs[i].latency,
+                                   configs[i].threshold);
+    r.total = 0;
+    atomic_store(&r.done, 0);
+
+    t0 = now_ns();
+    pthread_create(&thread, NULL, produce, &r);
+
+    /* a UI thread redrawing at about 120 Hz */
+    do
+    {
+      nanosleep(&frame, NULL);
+      done = atomic_load(&r.done);
+      encoder_coalescer_drain(r.c, deltas);
+      ++drains;
+    } while (!done);
+
+    pthread_join(thread, NULL);
+
+    for (size_t e = 0; e < ENCODERS; ++e)
+    {
+      sum += deltas[e];
+    }
+
+    if (sum != r.total)
+    {
+      fprintf(stderr, "result mismatch: %ld != %ld\n", sum, r.total);
+      return 1;
+    }
+
+    printf("%-10s %14.1f %12llu %16.1f %12lu\n", configs[i].name,
+           ACTIONS * 1e3 / (double)(now_ns() - t0),
+           (unsigned long long)encoder_coalescer_releases(r.c),
+           (double)ACTIONS / (double)encoder_coalescer_releases(r.c), drains);
+
+    encoder_coalescer_destroy(r.c);
+  }
+
+  return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/fused.h>
+
+enum
+{
+  SAMPLES = 1 << 20,
+  ROUNDS = 32
+};
+
+typedef void (*init_func)(encoder_state*, encoder_byte_t);
+typedef enum encoder_action (*update_func)(encoder_state*,
+                                           encoder_fast_byte_t);
+typedef encoder_fused_t const (*fused_table_type)[4];
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static enum encoder_action full_tt(encoder_state* s, encoder_fast_byte_t t)
+{
+  return encoder_debounced_full_step_update_tt(s, t);
+}
+
+static enum encoder_action half_tt(encoder_state* s, encoder_fast_byte_t t)
+{
+  return encoder_debounced_half_step_update_tt(s, t);
+}
+
+/*
+ * Random walk along the gray code sequence. Every transition is followed
+ * by `bounce` samples that randomly chatter between the old and the new
+ * position, and every sample is replaced by random noise with a chance
+ * of 1 in `noise` (or never if `noise` is zero).
+ */
+static void make_samples(encoder_byte_t* samples, int bounce, int noise)
+{
+  static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+  unsigned pos = 0;
+  size_t i = 0;
+
+  while (i < SAMPLES)
+  {
+    unsigned const prev = pos;
+
+    pos += rand() % 4 == 0 ? -1 : 1;
+
+    for (int k = 0; k < bounce && i < SAMPLES; ++k)
+    {
+      samples[i++] = gray[(rand() % 2 ? pos : prev) % 4];
+    }
+
+    if (i < SAMPLES)
+    {
+      samples[i++] = gray[pos % 4];
+    }
+  }
+
+  if (noise)
+  {
+    for (i = 0; i < SAMPLES; ++i)
+    {
+      if (rand() % noise == 0)
+      {
+        samples[i] = rand() % 4;
+      }
+    }
+  }
+}
+
+static double run(init_func init, update_func update,
+                   encoder_byte_t const* samples, long* delta)
+{
+  encoder_state es;
+  double t0;
+
+  init(&es, samples[0]);
+  *delta = 0;
+
+  t0 = now();
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    for (size_t i = 0; i < SAMPLES; ++i)
+    {
+      /* no branches here, so we only measure those in `update` */
+      unsigned const action = update(&es, samples[i]);
+      *delta += (long)(action & 1) - (long)(action >> 1);
+    }
+  }
+
+  return (now() - t0) * 1e9 / ((double)SAMPLES * ROUNDS);
+}
+
+static double run_fused(init_func init, fused_table_type table,
+                        encoder_byte_t const* samples, long* delta)
+{
+  encoder_state es;
+  encoder_fused_t w;
+  double t0;
+
+  init(&es, samples[0]);
+  encoder_fused_init(&w, es);
+
+  t0 = now();
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    for (size_t i = 0; i < SAMPLES; ++i)
+    {
+      encoder_fused_update(&w, samples[i], table);
+    }
+  }
+
+  *delta = encoder_fused_position(w);
+
+  return (now() - t0) * 1e9 / ((double)SAMPLES * ROUNDS);
+}
+
+int main(void)
+{
+  static struct
+  {
+    char const* name;
+    int bounce;
+    int noise;
+  } const inputs[] = {
+      {"clean", 0, 0},
+      {"bounce-2", 2, 0},
+      {"bounce-8", 8, 0},
+      {"noisy", 2, 8},
+      {"random", 0, 1},
+  };
+
+  static struct
+  {
+    char const* name;
+    init_func init;
+    update_func update[3];
+    fused_table_type fused_table;
+  } const flavours[] = {
+      {"full",
+       encoder_debounced_full_step_init,
+       {encoder_debounced_full_step_update,
+        encoder_debounced_full_step_update_branchless, full_tt},
+       encoder_debounced_full_step_fused_table},
+      {"half",
+       encoder_debounced_half_step_init,
+       {encoder_debounced_half_step_update,
+        encoder_debounced_half_step_update_branchless, half_tt},
+       encoder_debounced_half_step_fused_table},
+  };
+
+  encoder_byte_t* samples = malloc(SAMPLES);
+
+  printf("%-5s %-9s %12s %12s %12s %12s\n", "", "input", "code [ns]",
+         "branchless", "tt", "fused");
+
+  for (size_t f = 0; f < sizeof(flavours) / sizeof(flavours[0]); ++f)
+  {
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i)
+    {
+      double t[4];
+      long delta[4];
+
+      srand(42);
+      make_samples(samples, inputs[i].bounce, inputs[i].noise);
+
+      for (int u = 0; u < 3; ++u)
+      {
+        t[u] = run(flavours[f].init, flavours[f].update[u], samples,
+                   &delta[u]);
+      }
+
+      t[3] = run_fused(flavours[f].init, flavours[f].fused_table, samples,
+                       &delta[3]);
+
+      if (delta[1] != delta[0] || delta[2] != delta[0] ||
+          delta[3] != delta[0])
+      {
+        fprintf(stderr, "result mismatch: %ld/%ld/%ld/%ld\n", delta[0],
+                delta[1], delta[2], delta[3]);
+        return 1;
+      }
+
+      printf("%-5s %-9s %12.2f %12.2f %12.2f %12.2f\n", flavours[f].name,
+             inputs[i].name, t[0], t[1], t[2], t[3]);
+    }
+  }
+
+  free(samples);
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rotaryencoder/analog.h>
+
+enum
+{
+  FRAMES = 1 << 16,
+  ROUNDS = 64
+};
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 12-bit sin/cos signals of a randomly turning encoder, with noise */
+static void make_samples(uint16_t* samples)
+{
+  double phase = 0;
+
+  for (size_t i = 0; i < FRAMES; ++i)
+  {
+    phase += (rand() % 101 - 40) * 1e-3;
+    samples[2 * i] = (uint16_t)(2048 + 1500 * cos(phase) + rand() % 21 - 10);
+    samples[2 * i + 1] =
+        (uint16_t)(2048 + 1500 * sin(phase) + rand() % 21 - 10);
+  }
+}
+
+int main(void)
+{
+  uint16_t* samples = malloc(2 * FRAMES * sizeof(*samples));
+  encoder_position_t* positions = malloc(FRAMES * sizeof(*positions));
+  encoder_interpolator ip;
+  encoder_position_t sum[2] = {0, 0};
+  double t[2];
+
+  srand(42);
+  make_samples(samples);
+
+  encoder_interpolator_init(&ip, 2048, 2048, 50, samples[0], samples[1]);
+  t[0] = now();
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    for (size_t i = 0; i < FRAMES; ++i)
+    {
+      sum[0] += encoder_interpolator_update(&ip, samples[2 * i],
+                                            samples[2 * i + 1]);
+    }
+  }
+
+  t[0] = now() - t[0];
+
+  encoder_interpolator_init(&ip, 2048, 2048, 50, samples[0], samples[1]);
+  t[1] = now();
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    encoder_interpolator_update_batch(&ip, samples, 2, positions, FRAMES);
+
+    for (size_t i = 0; i < FRAMES; ++i)
+    {
+      sum[1] += positions[i];
+    }
+  }
+
+  t[1] = now() - t[1];
+
+  if (sum[0] != sum[1])
+  {
+    fprintf(stderr, "result mismatch: %ld/%ld\n", sum[0], sum[1]);
+    return 1;
+  }
+
+  printf("%-8s %12s %12s\n", "", "ns/frame", "Mframes/s");
+
+  for (int k = 0; k < 2; ++k)
+  {
+    double const ns = t[k] * 1e9 / ((double)FRAMES * ROUNDS);
+    printf("%-8s %12.2f %12.1f\n", k ? "batch" : "scalar", ns, 1e3 / ns);
+  }
+
+  free(positions);
+  free(samples);
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rotaryencoder/majority.h>
+
+enum
+{
+  WORDS = 1 << 14,
+  ROUNDS = 64,
+  HOLD = 16
+};
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Random walk, holding each gray code position for HOLD samples, with one
+ * in 8 samples replaced by noise.
+ */
+static void make_samples(uint64_t* samples, size_t words)
+{
+  static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+  unsigned pos = 0;
+  int left = 0;
+
+  for (size_t i = 0; i < words; ++i)
+  {
+    uint64_t w = 0;
+
+    for (unsigned k = 0; k < 64; k += 2)
+    {
+      if (left-- <= 0)
+      {
+        pos += rand() % 4 == 0 ? -1 : 1;
+        left = HOLD - 1;
+      }
+
+      w |= (uint64_t)(rand() % 8 ? gray[pos % 4] : rand() % 4) << k;
+    }
+
+    samples[i] = w;
+  }
+}
+
+static double run_filter(unsigned window, uint64_t const* samples,
+                         uint64_t* out)
+{
+  encoder_majority m;
+  double t0;
+
+  encoder_majority_init(&m, window, 0x3);
+
+  t0 = now();
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    encoder_majority_filter(&m, samples, out, WORDS);
+  }
+
+  return (double)WORDS * 32 * ROUNDS / (now() - t0);
+}
+
+static double run_decode(unsigned window, uint64_t const* samples,
+                         encoder_position_t* delta)
+{
+  encoder_majority m;
+  encoder_state es;
+  double t0;
+
+  encoder_majority_init(&m, window, 0x3);
+  encoder_debounced_half_step_init(&es, 0x3);
+  *delta = 0;
+
+  t0 = now();
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    *delta += encoder_majority_update_batch_tt(
+        &m, &es, samples, NULL, WORDS, encoder_debounced_half_step_table);
+  }
+
+  return (double)WORDS * 32 * ROUNDS / (now() - t0);
+}
+
+int main(void)
+{
+  static unsigned const windows[] = {1, 3, 5, 9, 15, 31};
+  uint64_t* samples = malloc(WORDS * sizeof(uint64_t));
+  uint64_t* out = malloc(WORDS * sizeof(uint64_t));
+
+  srand(42);
+  make_samples(samples, WORDS);
+
+  printf("%6s %16s %16s %10s\n", "window", "filter [MS/s]", "decode [MS/s]",
+         "delta");
+
+  for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); ++w)
+  {
+    encoder_position_t delta;
+    double const filter = run_filter(windows[w], samples, out);
+    double const decode = run_decode(windows[w], samples, &delta);
+
+    printf("%6u %16.1f %16.1f %10ld\n", windows[w], filter * 1e-6,
+           decode * 1e-6, delta);
+  }
+
+  free(out);
+  free(samples);
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rotaryencoder/parallel.h>
+
+enum
+{
+  JOBS = 256,
+  MIN_WORDS = 256,
+  MAX_WORDS = 1 << 20,
+  ROUNDS = 4
+};
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static encoder_state states[JOBS];
+static encoder_parallel_job jobs[JOBS];
+static uint64_t* samples[JOBS];
+
+static void reset(void)
+{
+  for (size_t j = 0; j < JOBS; ++j)
+  {
+    encoder_debounced_full_step_init(&states[j], 0x3);
+  }
+}
+
+int main(void)
+{
+  static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+  uint64_t total = 0;
+  double sequential;
+
+  /*
+   * Pareto distributed stream lengths, so that a few streams hold most of
+   * the samples, as is typical for captures of differing durations.
+   */
+  srand(42);
+  for (size_t j = 0; j < JOBS; ++j)
+  {
+    double const u = (rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double const length = MIN_WORDS / pow(u, 1 / 1.2);
+    size_t const words = length < MAX_WORDS ? (size_t)length : MAX_WORDS;
+    unsigned pos = 0;
+
+    samples[j] = malloc(words * sizeof(uint64_t));
+
+    for (size_t w = 0; w < words; ++w)
+    {
+      uint64_t word = 0;
+
+      for (unsigned k = 0; k < 64; k += 2)
+      {
+        pos += rand() % 3 - 1;
+        word |= (uint64_t)gray[pos % 4] << k;
+      }
+
+      samples[j][w] = word;
+    }
+
+    jobs[j] = (encoder_parallel_job){&states[j],
+                                     samples[j],
+                                     malloc(words * sizeof(uint64_t)),
+                                     words,
+                                     encoder_debounced_full_step_table,
+                                     0};
+    total += words * 32;
+  }
+
+  sequential = now();
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    reset();
+    for (size_t j = 0; j < JOBS; ++j)
+    {
+      jobs[j].delta = encoder_batch_update_tt(
+          jobs[j].state, jobs[j].samples, jobs[j].actions, jobs[j].words,
+          jobs[j].table);
+    }
+  }
+  sequential = (double)total * ROUNDS / (now() - sequential);
+
+  printf("%zu streams, %.1f MS in total, sequential: %.1f MS/s\n\n",
+         (size_t)JOBS, total * 1e-6, sequential * 1e-6);
+  printf("%8s %14s %8s %8s %8s %8s\n", "threads", "rate [MS/s]", "speedup",
+         "chunks", "steals", "resyncs");
+
+  for (unsigned threads = 1; threads <= 8; threads *= 2)
+  {
+    encoder_parallel_stats stats;
+    double best = 0;
+
+    for (int r = 0; r < ROUNDS; ++r)
+    {
+      reset();
+      encoder_parallel_decode(jobs, JOBS, threads, 0, &stats);
+      best = stats.samples_per_second > best ? stats.samples_per_second
+                                             : best;
+    }
+
+    printf("%8u %14.1f %7.2fx %8zu %8zu %8zu\n", threads, best * 1e-6,
+           best / sequential, stats.chunks, stats.steals, stats.resyncs);
+  }
+
+  for (size_t j = 0; j < JOBS; ++j)
+  {
+    free(samples[j]);
+    free(jobs[j].actions);
+  }
+
+  return 0;
+}
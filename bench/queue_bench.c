@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <rotaryencoder/queue.h>
+
+enum
+{
+  MAX_PRODUCERS = 8,
+  EVENTS = 1 << 20,
+  CAPACITY = 1 << 12
+};
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * The baseline: a ring of the same capacity protected by a mutex, with
+ * the same batch semantics.
+ */
+struct locked_queue
+{
+  pthread_mutex_t mutex;
+  encoder_event events[CAPACITY];
+  size_t head;
+  size_t tail;
+};
+
+static size_t locked_push(void* arg, encoder_event const* events,
+                          size_t count)
+{
+  struct locked_queue* q = arg;
+  size_t n;
+
+  pthread_mutex_lock(&q->mutex);
+  n = CAPACITY - (q->head - q->tail);
+  n = count < n ? count : n;
+  for (size_t i = 0; i < n; ++i)
+  {
+    q->events[(q->head + i) % CAPACITY] = events[i];
+  }
+  q->head += n;
+  pthread_mutex_unlock(&q->mutex);
+
+  return n;
+}
+
+static size_t locked_pop(void* arg, encoder_event* events, size_t max)
+{
+  struct locked_queue* q = arg;
+  size_t n;
+
+  pthread_mutex_lock(&q->mutex);
+  n = q->head - q->tail;
+  n = max < n ? max : n;
+  for (size_t i = 0; i < n; ++i)
+  {
+    events[i] = q->events[(q->tail + i) % CAPACITY];
+  }
+  q->tail += n;
+  pthread_mutex_unlock(&q->mutex);
+
+  return n;
+}
+
+static size_t lockfree_push(void* arg, encoder_event const* events,
+                            size_t count)
+{
+  return encoder_event_queue_push(arg, events, count);
+}
+
+static size_t lockfree_pop(void* arg, encoder_event* events, size_t max)
+{
+  return encoder_event_queue_pop(arg, events, max);
+}
+
+struct run
+{
+  void* q;
+  size_t (*push)(void*, encoder_event const*, size_t);
+  size_t (*pop)(void*, encoder_event*, size_t);
+  size_t batch;
+  size_t events;
+  atomic_size_t full;
+};
+
+static void* produce(void* arg)
+{
+  struct run* r = arg;
+  encoder_event batch[64];
+
+  for (size_t i = 0; i < r->batch; ++i)
+  {
+    batch[i] = (encoder_event){i, (uint32_t)i, ENCODER_ACTION_TURN_CW};
+  }
+
+  for (size_t k = 0; k < r->events; k += r->batch)
+  {
+    size_t n = 0;
+
+    while (n < r->batch)
+    {
+      size_t const pushed = r->push(r->q, batch + n, r->batch - n);
+
+      if (pushed == 0)
+      {
+        atomic_fetch_add_explicit(&r->full, 1, memory_order_relaxed);
+        sched_yield();
+      }
+
+      n += pushed;
+    }
+  }
+
+  return NULL;
+}
+
+static double run(struct run* r, size_t producers)
+{
+  pthread_t thread[MAX_PRODUCERS];
+  size_t const total = producers * r->events;
+  size_t received = 0;
+  double t0 = now();
+
+  atomic_init(&r->full, 0);
+
+  for (size_t p = 0; p < producers; ++p)
+  {
+    pthread_create(&thread[p], NULL, produce, r);
+  }
+
+  while (received < total)
+  {
+    encoder_event out[256];
+    size_t const n = r->pop(r->q, out, 256);
+
+    if (n == 0)
+    {
+      sched_yield();
+    }
+
+    received += n;
+  }
+
+  for (size_t p = 0; p < producers; ++p)
+  {
+    pthread_join(thread[p], NULL);
+  }
+
+  return (double)total / (now() - t0);
+}
+
+int main(void)
+{
+  static struct locked_queue locked;
+  encoder_event_queue* q = encoder_event_queue_create(CAPACITY);
+
+  pthread_mutex_init(&locked.mutex, NULL);
+
+  printf("%9s %6s %16s %16s %8s %12s\n", "producers", "batch",
+         "mutex [Mev/s]", "lockfree [Mev/s]", "speedup", "full/Mev");
+
+  for (size_t producers = 1; producers <= MAX_PRODUCERS; producers *= 2)
+  {
+    for (size_t batch = 1; batch <= 64; batch *= 8)
+    {
+      size_t const events = EVENTS / producers / batch * batch;
+      struct run a = {&locked, locked_push, locked_pop, batch, events, 0};
+      struct run b = {q, lockfree_push, lockfree_pop, batch, events, 0};
+      double const mutex = run(&a, producers);
+      double const lockfree = run(&b, producers);
+
+      printf("%9zu %6zu %16.1f %16.1f %7.2fx %12.1f\n", producers, batch,
+             mutex * 1e-6, lockfree * 1e-6, lockfree / mutex,
+             (double)atomic_load(&b.full) * 1e6 / (double)(producers * events));
+    }
+  }
+
+  encoder_event_queue_destroy(q);
+  pthread_mutex_destroy(&locked.mutex);
+
+  return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <rotaryencoder/ranges.h>
+
+namespace
+{
+
+using namespace rotaryencoder;
+
+double now()
+{
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+std::vector<encoder_byte_t> walk(std::size_t size, int move)
+{
+  static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+  std::vector<encoder_byte_t> samples(size);
+  unsigned pos = 0;
+
+  for (auto& s : samples)
+  {
+    int const r = std::rand() % 256;
+    pos += r < move ? 1 : r < 2 * move ? 3 : 0;
+    s = gray[pos % 4];
+  }
+
+  return samples;
+}
+
+template <typename Encoder>
+encoder_position_t hand_loop(std::vector<encoder_byte_t> const& samples)
+{
+  Encoder enc(samples[0]);
+  encoder_position_t position = 0;
+
+  for (auto s : samples)
+  {
+    switch (enc.update(s))
+    {
+    case ENCODER_ACTION_TURN_CW:
+      ++position;
+      break;
+    case ENCODER_ACTION_TURN_CCW:
+      --position;
+      break;
+    case ENCODER_ACTION_NONE:
+      break;
+    }
+  }
+
+  return position;
+}
+
+template <typename Encoder>
+encoder_position_t decode_view(std::vector<encoder_byte_t> const& samples)
+{
+  encoder_position_t position = 0;
+
+  for (auto a : samples | views::decode<Encoder>())
+  {
+    position += a == ENCODER_ACTION_TURN_CW    ? 1
+                : a == ENCODER_ACTION_TURN_CCW ? -1
+                                               : 0;
+  }
+
+  return position;
+}
+
+template <typename Encoder>
+encoder_position_t steps_view(std::vector<encoder_byte_t> const& samples)
+{
+  encoder_position_t position = 0;
+
+  for (auto const& s : samples | views::steps<Encoder>())
+  {
+    position = s.position;
+  }
+
+  return position;
+}
+
+template <typename F>
+double rate(F f, std::vector<encoder_byte_t> const& samples,
+            encoder_position_t& position)
+{
+  double best = 0;
+
+  for (int r = 0; r < 5; ++r)
+  {
+    double const t0 = now();
+    position = f(samples);
+    double const t = now() - t0;
+    best = samples.size() / t > best ? samples.size() / t : best;
+  }
+
+  return best;
+}
+
+template <typename Encoder>
+void run(char const* name, std::vector<encoder_byte_t> const& samples,
+         int move)
+{
+  encoder_position_t p_loop, p_decode, p_steps;
+  double const loop = rate(hand_loop<Encoder>, samples, p_loop);
+  double const decode = rate(decode_view<Encoder>, samples, p_decode);
+  double const steps = rate(steps_view<Encoder>, samples, p_steps);
+
+  std::printf("%-26s %5.1f%% %12.1f %12.1f %12.1f%s\n", name,
+              200.0 * move / 256, loop * 1e-6, decode * 1e-6, steps * 1e-6,
+              p_loop == p_decode && p_loop == p_steps ? "" : "  MISMATCH");
+}
+
+}
+
+int main()
+{
+  std::printf("%-26s %6s %12s %12s %12s\n", "[MS/s]", "moves", "loop",
+              "decode", "steps");
+
+  for (int move : {1, 8, 64})
+  {
+    auto const samples = walk(std::size_t(1) << 24, move);
+
+    run<debounced_encoder_full_step>("debounced_full_step", samples, move);
+    run<debounced_encoder_full_step_tt>("debounced_full_step_tt", samples,
+                                        move);
+    run<simple_encoder_quarter_step_imm>("simple_quarter_step_imm", samples,
+                                         move);
+    run<simple_encoder_quarter_step_tt>("simple_quarter_step_tt", samples,
+                                        move);
+  }
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <rotaryencoder/registry.h>
+
+enum
+{
+  MAX_THREADS = 64,
+  ENCODERS_PER_THREAD = 16,
+  SAMPLES = 1 << 12,
+  ROUNDS = 64
+};
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static encoder_byte_t samples[SAMPLES];
+
+/*
+ * The naive layout: flat arrays, with the encoders handled by the threads
+ * interleaved, so neighbouring states and positions belong to different
+ * threads.
+ */
+static encoder_state shared_states[MAX_THREADS * ENCODERS_PER_THREAD];
+static _Atomic encoder_position_t
+    shared_positions[MAX_THREADS * ENCODERS_PER_THREAD];
+
+struct worker
+{
+  encoder_registry* r;
+  size_t thread;
+  size_t threads;
+  pthread_barrier_t* barrier;
+};
+
+static void* run_shared(void* arg)
+{
+  struct worker const* w = arg;
+
+  pthread_barrier_wait(w->barrier);
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    for (size_t k = 0; k < SAMPLES; ++k)
+    {
+      for (size_t e = 0; e < ENCODERS_PER_THREAD; ++e)
+      {
+        size_t const i = e * w->threads + w->thread;
+        enum encoder_action const action = encoder_internal_update_tt(
+            &shared_states[i], samples[(k + e) % SAMPLES],
+            encoder_debounced_full_step_table);
+
+        if (action != ENCODER_ACTION_NONE)
+        {
+          atomic_store_explicit(
+              &shared_positions[i],
+              atomic_load_explicit(&shared_positions[i],
+                                   memory_order_relaxed) +
+                  (action == ENCODER_ACTION_TURN_CW ? 1 : -1),
+              memory_order_relaxed);
+        }
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static void* run_sharded(void* arg)
+{
+  struct worker const* w = arg;
+  encoder_registry_shard* shard = encoder_registry_get_shard(w->r, w->thread);
+
+  for (size_t e = 0; e < ENCODERS_PER_THREAD; ++e)
+  {
+    encoder_debounced_full_step_init(encoder_registry_state(shard, e),
+                                     samples[0]);
+  }
+
+  pthread_barrier_wait(w->barrier);
+
+  for (int r = 0; r < ROUNDS; ++r)
+  {
+    for (size_t k = 0; k < SAMPLES; ++k)
+    {
+      for (size_t e = 0; e < ENCODERS_PER_THREAD; ++e)
+      {
+        encoder_registry_update_tt(shard, e, samples[(k + e) % SAMPLES],
+                                   encoder_debounced_full_step_table);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static double run(void* (*func)(void*), size_t threads, encoder_registry* r)
+{
+  struct worker workers[MAX_THREADS];
+  pthread_t thread[MAX_THREADS];
+  pthread_barrier_t barrier;
+  double t0;
+
+  pthread_barrier_init(&barrier, NULL, (unsigned)threads + 1);
+
+  for (size_t t = 0; t < threads; ++t)
+  {
+    workers[t] = (struct worker){r, t, threads, &barrier};
+    pthread_create(&thread[t], NULL, func, &workers[t]);
+  }
+
+  pthread_barrier_wait(&barrier);
+  t0 = now();
+
+  for (size_t t = 0; t < threads; ++t)
+  {
+    pthread_join(thread[t], NULL);
+  }
+
+  t0 = now() - t0;
+  pthread_barrier_destroy(&barrier);
+
+  return (double)threads * ENCODERS_PER_THREAD * SAMPLES * ROUNDS / t0;
+}
+
+int main(void)
+{
+  static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+  unsigned pos = 0;
+
+  /* a random walk along the gray code sequence */
+  srand(42);
+  for (size_t k = 0; k < SAMPLES; ++k)
+  {
+    pos += rand() % 3 - 1;
+    samples[k] = gray[pos % 4];
+  }
+
+  printf("%8s %18s %18s %8s\n", "threads", "shared [MS/s]", "sharded [MS/s]",
+         "speedup");
+
+  for (size_t threads = 1; threads <= MAX_THREADS; threads *= 2)
+  {
+    encoder_registry* r = encoder_registry_create(
+        threads * ENCODERS_PER_THREAD, threads, ENCODER_REGISTRY_FIRST_TOUCH);
+    double shared, sharded;
+
+    for (size_t i = 0; i < threads * ENCODERS_PER_THREAD; ++i)
+    {
+      encoder_debounced_full_step_init(&shared_states[i], samples[0]);
+    }
+
+    shared = run(run_shared, threads, NULL);
+    sharded = run(run_sharded, threads, r);
+
+    printf("%8zu %18.1f %18.1f %7.2fx\n", threads, shared * 1e-6,
+           sharded * 1e-6, sharded / shared);
+
+    encoder_registry_destroy(r);
+  }
+
+  return 0;
+}
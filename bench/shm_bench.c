@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <rotaryencoder/shm.h>
+
+enum
+{
+  READERS = 3,
+  DURATION_MS = 200,
+  PERIOD_US = 100
+};
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct reader
+{
+  char const* name;
+  atomic_int* stop;
+  unsigned long reads;
+  unsigned long retries;
+};
+
+/* each reader maps the table separately, like a separate process would */
+static void* read_positions(void* arg)
+{
+  struct reader* r = arg;
+  encoder_shm* shm = encoder_shm_open(r->name);
+  size_t const count = encoder_shm_count(shm);
+  encoder_position_t* positions = malloc(count * sizeof(*positions));
+
+  while (!atomic_load_explicit(r->stop, memory_order_relaxed))
+  {
+    r->retries += encoder_shm_read(shm, 0, positions, count);
+    ++r->reads;
+  }
+
+  free(positions);
+  encoder_shm_close(shm);
+
+  return NULL;
+}
+
+/* the decoding process publishing after every batch */
+static void publish(encoder_shm* shm, encoder_position_t* positions,
+                    size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    positions[i] += (encoder_position_t)(i & 3) - 1;
+  }
+
+  encoder_shm_publish(shm, 0, positions, count);
+}
+
+int main(void)
+{
+  static size_t const counts[] = {1, 7, 64, 512, 4096};
+  char name[64];
+
+  snprintf(name, sizeof(name), "/rotaryencoder_shm_bench.%ld",
+           (long)getpid());
+
+  printf("%8s %18s %18s %12s\n", "encoders", "writer [Mpos/s]",
+         "readers [Mpos/s]", "retries [%]");
+
+  for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+  {
+    size_t const count = counts[c];
+    encoder_shm* shm = encoder_shm_create(name, count);
+    encoder_position_t* positions = calloc(count, sizeof(*positions));
+    struct reader readers[READERS];
+    pthread_t threads[READERS];
+    atomic_int stop = 0;
+    unsigned long writes = 0, reads = 0, retries = 0;
+    double t0, t, writer;
+
+    if (!shm)
+    {
+      perror("encoder_shm_create");
+      return 1;
+    }
+
+    t0 = now();
+
+    /* the writer on its own */
+    do
+    {
+      publish(shm, positions, count);
+      ++writes;
+    } while ((t = now() - t0) < DURATION_MS * 1e-3);
+
+    writer = writes * count / t;
+
+    for (int r = 0; r < READERS; ++r)
+    {
+      readers[r] = (struct reader){name, &stop, 0, 0};
+      pthread_create(&threads[r], NULL, read_positions, &readers[r]);
+    }
+
+    t0 = now();
+
+    /* readers, with the writer publishing a batch every PERIOD_US */
+    do
+    {
+      struct timespec const period = {0, PERIOD_US * 1000};
+      nanosleep(&period, NULL);
+      publish(shm, positions, count);
+    } while ((t = now() - t0) < DURATION_MS * 1e-3);
+
+    atomic_store(&stop, 1);
+
+    for (int r = 0; r < READERS; ++r)
+    {
+      pthread_join(threads[r], NULL);
+      reads += readers[r].reads;
+      retries += readers[r].retries;
+    }
+
+    printf("%8zu %18.1f %18.1f %12.3f\n", count, writer * 1e-6,
+           reads * count / t * 1e-6,
+           100.0 * retries /
+               (reads * ((count + ENCODER_SHM_LINE_POSITIONS - 1) /
+                         ENCODER_SHM_LINE_POSITIONS)));
+
+    free(positions);
+    encoder_shm_close(shm);
+    encoder_shm_unlink(name);
+  }
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_ACCELERATION_H
+#define INCLUDE_ROTARYENCODER_ACCELERATION_H
+
+#include <rotaryencoder/common.h>
+
+/*
+ * Acceleration for menu and parameter knobs: the faster the encoder is
+ * turned, the larger the increment per step.
+ *
+ * The multiplier is looked up in a curve, indexed by the interval between
+ * steps averaged over the last steps. The curve is a table of multipliers
+ * in 8.8 fixed point (ENCODER_ACCEL_ONE is 1x) for the intervals
+ * 0, 1 << shift, 2 << shift, and so on, with the last entry applying to
+ * all longer intervals. encoder_accel_update() uses the entry for the
+ * closest shorter interval, while encoder_accel_update_linear()
+ * interpolates between entries. Fractional multipliers are carried over
+ * to the next step, so e.g. 1.5x yields increments of 1 and 2 in turns.
+ * Multipliers must be less than 255x.
+ *
+ * Timestamps are supplied by the caller in arbitrary units, e.g.
+ * milliseconds, and may wrap around. Intervals longer than the range of
+ * `unsigned` will be misinterpreted. `size << shift` must not exceed
+ * 32768. A change of direction restarts at the multiplier for the longest
+ * interval.
+ *
+ *   static unsigned short ENCODER_CONST_MEMORY curve_table[] = {
+ *       8 * ENCODER_ACCEL_ONE, 4 * ENCODER_ACCEL_ONE, 2 * ENCODER_ACCEL_ONE,
+ *       ENCODER_ACCEL_ONE};
+ *   static encoder_accel_curve const curve = {curve_table, 4, 4};
+ *
+ *   action = encoder_debounced_full_step_update(&es, terminal);
+ *   value += encoder_accel_update(&acc, &curve, action, millis());
+ */
+
+#define ENCODER_ACCEL_ONE 256
+
+typedef struct encoder_accel_curve
+{
+  unsigned short ENCODER_CONST_MEMORY* table;
+  encoder_byte_t size;
+  encoder_byte_t shift;
+} encoder_accel_curve;
+
+typedef struct encoder_accel
+{
+  unsigned last;
+  unsigned interval;
+  encoder_byte_t fraction;
+  encoder_byte_t direction;
+} encoder_accel;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  static ENCODER_INLINE void encoder_accel_init(encoder_accel* a)
+  {
+    a->last = 0;
+    a->interval = 0;
+    a->fraction = 0;
+    a->direction = ENCODER_ACTION_NONE;
+  }
+
+  /*
+   * Returns the signed increment for `action` at time `now`, or zero if
+   * there was no action.
+   */
+  int encoder_accel_update(encoder_accel* a, encoder_accel_curve const* c,
+                           enum encoder_action action, unsigned now);
+
+  int encoder_accel_update_linear(encoder_accel* a,
+                                  encoder_accel_curve const* c,
+                                  enum encoder_action action, unsigned now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_ANALOG_H
+#define INCLUDE_ROTARYENCODER_ANALOG_H
+
+#include <rotaryencoder/batch.h>
+#include <rotaryencoder/interpolation.h>
+
+/*
+ * Analog front end for encoders with analog (e.g. magnetic or optical)
+ * outputs.
+ *
+ * The ADC samples of the A and B channels are converted to terminal values
+ * using a Schmitt trigger per channel: the terminal goes high when the
+ * sample is at least `high`, low when the sample is less than `low`, and
+ * keeps its level otherwise. `low` must not be greater than `high`.
+ *
+ * Samples are read in frames of `stride` samples, with the A channel in the
+ * first and the B channel in the second sample of each frame, which matches
+ * the output of an ADC in scan mode. Other layouts can be handled by
+ * adjusting the `samples` pointer and `stride`. Samples are processed in
+ * blocks of 32 frames, producing one packed word in the format used by
+ * the batch functions per block.
+ */
+
+typedef struct encoder_analog
+{
+  uint16_t low[2];
+  uint16_t high[2];
+  encoder_byte_t terminal;
+} encoder_analog;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Set up the thresholds of the A and B channels. `terminal` holds the
+   * initial levels of both channels.
+   */
+  static ENCODER_INLINE void
+  encoder_analog_init(encoder_analog* a, uint16_t low_a, uint16_t high_a,
+                      uint16_t low_b, uint16_t high_b,
+                      encoder_fast_byte_t terminal)
+  {
+    a->low[0] = low_a;
+    a->high[0] = high_a;
+    a->low[1] = low_b;
+    a->high[1] = high_b;
+    a->terminal = (encoder_byte_t)terminal;
+  }
+
+  /*
+   * Convert `words` blocks of 32 frames into packed terminal values.
+   */
+  void encoder_analog_pack(encoder_analog* a, uint16_t const* samples,
+                           size_t stride, uint64_t* terminals, size_t words);
+
+  /*
+   * Convert and decode `words` blocks of 32 frames in a single pass, without
+   * storing the terminal values. `s`, `actions` and the return value are the
+   * same as for encoder_batch_update_tt().
+   */
+  encoder_position_t encoder_analog_update_batch_tt(
+      encoder_analog* a, encoder_state* s, uint16_t const* samples,
+      size_t stride, uint64_t* actions, size_t words,
+      encoder_byte_t ENCODER_CONST_MEMORY table[][4]);
+
+  /*
+   * Interpolate `frames` frames of sin/cos samples, using the same frame
+   * layout as above, and store the position after each frame in
+   * `positions`. The results are identical to calling
+   * encoder_interpolator_update() for each frame, but the angles are
+   * computed for several frames at once.
+   */
+  void encoder_interpolator_update_batch(encoder_interpolator* ip,
+                                         uint16_t const* samples,
+                                         size_t stride,
+                                         encoder_position_t* positions,
+                                         size_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_ATOMIC_H
+#define INCLUDE_ROTARYENCODER_ATOMIC_H
+
+#include <rotaryencoder/common.h>
+
+/*
+ * Updates of a `_tt` encoder state that may be called concurrently, e.g.
+ * from a polling timer and a pin-change interrupt, or from several threads.
+ *
+ * The transition is applied using a compare-and-swap loop on the state, so
+ * each observed terminal value is applied exactly once, to the state left
+ * by the previous update, without disabling interrupts or taking a lock.
+ * On CPUs with load-linked/store-conditional instructions (e.g. ARMv7-M),
+ * this compiles to an LDREXB/STREXB loop. On CPUs without either (e.g.
+ * ARMv6-M or AVR), the compiler may fall back to library calls, which
+ * typically disable interrupts instead.
+ *
+ * All concurrent updates of a state must use these functions; mixing them
+ * with the regular update functions brings back the race. The returned
+ * action must be applied atomically as well if the position is shared,
+ * which encoder_atomic_update_position_tt() does.
+ *
+ * These functions rely on the `__atomic` builtins of GCC and Clang, and
+ * ENCODER_HAVE_ATOMIC_UPDATE is only defined if they are available.
+ */
+
+#if defined(__GNUC__) && defined(__ATOMIC_RELAXED)
+
+#define ENCODER_HAVE_ATOMIC_UPDATE 1
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_atomic_update_tt(encoder_state* s, encoder_fast_byte_t terminal,
+                           encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+  {
+    encoder_state state = __atomic_load_n(s, __ATOMIC_RELAXED);
+    encoder_fast_byte_t next;
+
+    do
+    {
+      next = table[state][terminal];
+    } while (!__atomic_compare_exchange_n(
+        s, &state, (encoder_state)(next & ENCODER_INTERNAL_STATE_MASK_TT), 1,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return (enum encoder_action)(next >> ENCODER_INTERNAL_ACTION_SHIFT_TT);
+  }
+
+  /*
+   * Same as encoder_atomic_update_tt(), but also adds the action to
+   * `position`.
+   */
+  static ENCODER_INLINE enum encoder_action
+  encoder_atomic_update_position_tt(
+      encoder_state* s, encoder_position_t* position,
+      encoder_fast_byte_t terminal,
+      encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+  {
+    enum encoder_action const action =
+        encoder_atomic_update_tt(s, terminal, table);
+
+    if (action == ENCODER_ACTION_TURN_CW)
+    {
+      __atomic_fetch_add(position, 1, __ATOMIC_RELAXED);
+    }
+    else if (action == ENCODER_ACTION_TURN_CCW)
+    {
+      __atomic_fetch_sub(position, 1, __ATOMIC_RELAXED);
+    }
+
+    return action;
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_BATCH_H
+#define INCLUDE_ROTARYENCODER_BATCH_H
+
+#include <stddef.h>
+
+#include <rotaryencoder/common.h>
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/simple_encoder.h>
+
+#if !defined(UINT64_MAX)
+#error "rotaryencoder/batch.h requires a C99 or C++11 compiler"
+#endif
+
+/*
+ * Batch decoding of packed samples.
+ *
+ * Each 64-bit word holds 32 consecutive terminal values, with the first
+ * sample in the least significant two bits. Actions are written in the
+ * same layout, i.e. action k of word i is (actions[i] >> 2 * k) & 0x3.
+ * `actions` may be NULL if only the net step count is needed. If the
+ * number of samples is not a multiple of 32, the last word can be padded
+ * by repeating the last sample, as repeated samples never cause actions.
+ *
+ * All batch functions are based on the transition tables, so the state
+ * is compatible with the `_tt` implementations. The return value is the
+ * number of clockwise minus the number of counter-clockwise actions.
+ */
+
+/*
+ * The batch functions dispatch to the fastest implementation supported by
+ * the CPU, which is selected once at startup. The selection can be
+ * overridden by setting the ROTARYENCODER_BATCH_ISA environment variable
+ * to the name of an implementation (see encoder_batch_isa_name()), or at
+ * runtime using encoder_batch_select_isa(), e.g. for benchmarking.
+ */
+
+enum encoder_batch_isa
+{
+  ENCODER_BATCH_ISA_AUTO,
+  ENCODER_BATCH_ISA_GENERIC,
+  ENCODER_BATCH_ISA_BMI2
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Returns the name of `isa`, or NULL if it isn't known.
+   */
+  char const* encoder_batch_isa_name(enum encoder_batch_isa isa);
+
+  /*
+   * Returns non-zero if `isa` is supported by both the build and the CPU.
+   */
+  int encoder_batch_isa_supported(enum encoder_batch_isa isa);
+
+  /*
+   * Use `isa` for all subsequent batch calls. ENCODER_BATCH_ISA_AUTO restores
+   * the selection made at startup. Returns 0 on success, or -1 if
+   * `isa` isn't supported, in which case the selection is left unchanged.
+   */
+  int encoder_batch_select_isa(enum encoder_batch_isa isa);
+
+  /*
+   * Returns the currently selected implementation.
+   */
+  enum encoder_batch_isa encoder_batch_selected_isa(void);
+
+  encoder_position_t
+  encoder_batch_update_tt(encoder_state* s, uint64_t const* samples,
+                          uint64_t* actions, size_t words,
+                          encoder_byte_t ENCODER_CONST_MEMORY table[][4]);
+
+  static ENCODER_INLINE encoder_position_t
+  encoder_simple_full_step_update_batch(encoder_state* s,
+                                        uint64_t const* samples,
+                                        uint64_t* actions, size_t words)
+  {
+    return encoder_batch_update_tt(s, samples, actions, words,
+                                   encoder_simple_full_step_table);
+  }
+
+  static ENCODER_INLINE encoder_position_t
+  encoder_simple_half_step_update_batch(encoder_state* s,
+                                        uint64_t const* samples,
+                                        uint64_t* actions, size_t words)
+  {
+    return encoder_batch_update_tt(s, samples, actions, words,
+                                   encoder_simple_half_step_table);
+  }
+
+  static ENCODER_INLINE encoder_position_t
+  encoder_simple_quarter_step_update_batch(encoder_state* s,
+                                           uint64_t const* samples,
+                                           uint64_t* actions, size_t words)
+  {
+    return encoder_batch_update_tt(s, samples, actions, words,
+                                   encoder_simple_quarter_step_table);
+  }
+
+  static ENCODER_INLINE encoder_position_t
+  encoder_debounced_full_step_update_batch(encoder_state* s,
+                                           uint64_t const* samples,
+                                           uint64_t* actions, size_t words)
+  {
+    return encoder_batch_update_tt(s, samples, actions, words,
+                                   encoder_debounced_full_step_table);
+  }
+
+  static ENCODER_INLINE encoder_position_t
+  encoder_debounced_half_step_update_batch(encoder_state* s,
+                                           uint64_t const* samples,
+                                           uint64_t* actions, size_t words)
+  {
+    return encoder_batch_update_tt(s, samples, actions, words,
+                                   encoder_debounced_half_step_table);
+  }
+
+  static ENCODER_INLINE encoder_position_t
+  encoder_debounced_full_step_recovering_update_batch(encoder_state* s,
+                                                      uint64_t const* samples,
+                                                      uint64_t* actions,
+                                                      size_t words)
+  {
+    return encoder_batch_update_tt(
+        s, samples, actions, words,
+        encoder_debounced_full_step_recovering_table);
+  }
+
+  static ENCODER_INLINE encoder_position_t
+  encoder_debounced_half_step_recovering_update_batch(encoder_state* s,
+                                                      uint64_t const* samples,
+                                                      uint64_t* actions,
+                                                      size_t words)
+  {
+    return encoder_batch_update_tt(
+        s, samples, actions, words,
+        encoder_debounced_half_step_recovering_table);
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_BUTTONS_H
+#define INCLUDE_ROTARYENCODER_BUTTONS_H
+
+#include <rotaryencoder/common.h>
+
+/*
+ * Debouncing of push buttons, e.g. those built into many encoders.
+ *
+ * Each bit of a word represents one button, with 1 meaning pressed, so
+ * active-low inputs must be inverted. All buttons of a word are debounced
+ * in parallel using "vertical" counters, which store bit k of the counters
+ * of all buttons in a single word: a button changes its debounced state
+ * after 4 consecutive scans that differ from that state.
+ *
+ * After each update, `pressed` and `released` hold the buttons that have
+ * changed their debounced state, and `long_pressed` the buttons that have
+ * been held down for `long_ticks` scans, counting the scan that reported
+ * the press. Long presses are reported once per press, but not for buttons
+ * that are already pressed when the debouncer is set up. `long_ticks`
+ * must be less than 2^ENCODER_BUTTONS_HOLD_BITS, and zero disables
+ * long presses.
+ *
+ * Debouncers are available for words of 8, 32 and, with a C99 compiler,
+ * 64 buttons: encoder_buttons8, encoder_buttons32 and encoder_buttons64.
+ */
+
+#ifndef ENCODER_BUTTONS_HOLD_BITS
+#define ENCODER_BUTTONS_HOLD_BITS 10
+#endif
+
+#define ENCODER_INTERNAL_BUTTONS(name, word)                                   \
+  typedef struct name                                                          \
+  {                                                                            \
+    word state;                                                                \
+    word pressed;                                                              \
+    word released;                                                             \
+    word long_pressed;                                                         \
+    word count[2];                                                             \
+    word hold[ENCODER_BUTTONS_HOLD_BITS];                                      \
+    word held;                                                                 \
+    unsigned long_ticks;                                                       \
+  } name;                                                                      \
+                                                                               \
+  static ENCODER_INLINE void name##_init(name* b, word state,                  \
+                                         unsigned long_ticks)                  \
+  {                                                                            \
+    encoder_fast_byte_t i;                                                     \
+                                                                               \
+    b->state = state;                                                          \
+    b->pressed = b->released = b->long_pressed = 0;                            \
+    b->count[0] = b->count[1] = (word)~(word)0;                                \
+    for (i = 0; i < ENCODER_BUTTONS_HOLD_BITS; ++i)                            \
+    {                                                                          \
+      b->hold[i] = 0;                                                          \
+    }                                                                          \
+    b->held = state;                                                           \
+    b->long_ticks = long_ticks;                                                \
+  }                                                                            \
+                                                                               \
+  static ENCODER_INLINE void name##_update(name* b, word raw)                  \
+  {                                                                            \
+    word change = (word)(raw ^ b->state);                                      \
+    word carry, match;                                                         \
+    encoder_fast_byte_t i;                                                     \
+                                                                               \
+    /* count down from 3 while the input differs, reset to 3 otherwise */      \
+    b->count[0] = (word)~(b->count[0] & change);                               \
+    b->count[1] = (word)(b->count[0] ^ (b->count[1] & change));                \
+    change &= (word)(b->count[0] & b->count[1]);                               \
+                                                                               \
+    b->state ^= change;                                                        \
+    b->pressed = (word)(change & b->state);                                    \
+    b->released = (word)(change & ~b->state);                                  \
+                                                                               \
+    /* count the scans of buttons held down until a long press */              \
+    carry = (word)(b->state & ~b->held);                                       \
+    match = b->long_ticks ? carry : 0;                                         \
+    for (i = 0; i < ENCODER_BUTTONS_HOLD_BITS; ++i)                            \
+    {                                                                          \
+      word const next = (word)(b->hold[i] & carry);                            \
+      b->hold[i] = (word)((b->hold[i] ^ carry) & b->state);                    \
+      carry = next;                                                            \
+      match &= (word)(b->long_ticks >> i & 1 ? b->hold[i] : ~b->hold[i]);      \
+    }                                                                          \
+                                                                               \
+    b->long_pressed = match;                                                   \
+    b->held = (word)((b->held | match) & b->state);                            \
+  }
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  ENCODER_INTERNAL_BUTTONS(encoder_buttons8, encoder_byte_t)
+
+#if defined(UINT32_MAX)
+  ENCODER_INTERNAL_BUTTONS(encoder_buttons32, uint32_t)
+#else
+  ENCODER_INTERNAL_BUTTONS(encoder_buttons32, unsigned long)
+#endif
+
+#if defined(UINT64_MAX)
+  ENCODER_INTERNAL_BUTTONS(encoder_buttons64, uint64_t)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_COALESCE_H
+#define INCLUDE_ROTARYENCODER_COALESCE_H
+
+#include <stddef.h>
+
+#include <rotaryencoder/common.h>
+
+#if !defined(UINT64_MAX)
+#error "rotaryencoder/coalesce.h requires a C99 or C++11 compiler"
+#endif
+
+/*
+ * Coalescing of actions for consumers in other threads, e.g. a UI that
+ * only needs the net movement of each encoder once per frame.
+ *
+ * The producer (the thread decoding the encoders) adds actions or deltas
+ * per encoder, which are accumulated privately. The accumulated delta of
+ * an encoder is handed off to the consumer once its magnitude reaches
+ * `threshold`, or once `latency` has passed since its first unreleased
+ * action. The handoff is lock-free: released deltas are added atomically
+ * to a per-encoder mailbox, and the consumer picks up the mailboxes of
+ * all encoders with pending data in a single drain call.
+ *
+ * Timestamps are supplied by the producer in arbitrary, monotonic units,
+ * which `latency` must use as well. As the latency is only checked when
+ * the producer calls into the coalescer, it must call
+ * encoder_coalescer_poll() regularly (e.g. once per batch of samples)
+ * while actions may be pending.
+ *
+ * Each coalescer supports a single producer and a single consumer thread.
+ * It is part of the host library, which requires C11 atomics.
+ */
+
+typedef struct encoder_coalescer encoder_coalescer;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Create a coalescer for `count` encoders. Returns NULL if the memory
+   * can't be allocated.
+   */
+  encoder_coalescer* encoder_coalescer_create(size_t count, uint64_t latency,
+                                              unsigned long threshold);
+
+  void encoder_coalescer_destroy(encoder_coalescer* c);
+
+  /*
+   * Add `delta` steps to the given encoder at time `now`. The deltas of
+   * the batch functions can be added directly.
+   */
+  void encoder_coalescer_add(encoder_coalescer* c, size_t encoder,
+                             encoder_position_t delta, uint64_t now);
+
+  /*
+   * Release the deltas of all encoders whose latency has expired at `now`.
+   */
+  void encoder_coalescer_poll(encoder_coalescer* c, uint64_t now);
+
+  /*
+   * Release the deltas of all encoders immediately.
+   */
+  void encoder_coalescer_flush(encoder_coalescer* c);
+
+  /*
+   * Returns the number of handoffs made by the producer so far.
+   */
+  uint64_t encoder_coalescer_releases(encoder_coalescer const* c);
+
+  /*
+   * Called by the consumer: add the deltas released since the last call
+   * to `deltas`, which must have an element per encoder. Returns the
+   * number of encoders with a non-zero delta.
+   */
+  size_t encoder_coalescer_drain(encoder_coalescer* c,
+                                 encoder_position_t* deltas);
+
+  static ENCODER_INLINE void
+  encoder_coalescer_add_action(encoder_coalescer* c, size_t encoder,
+                               enum encoder_action action, uint64_t now)
+  {
+    if (action != ENCODER_ACTION_NONE)
+    {
+      encoder_coalescer_add(c, encoder,
+                            action == ENCODER_ACTION_TURN_CW ? 1 : -1, now);
+    }
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
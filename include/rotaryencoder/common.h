@@ -39,6 +39,9 @@
 #define ENCODER_INTERNAL_ACTION_SHIFT_TT 4
 #define ENCODER_INTERNAL_STATE_MASK_TT 0x0F
 
+#define ENCODER_INTERNAL_IMM(state, terminal, action)                          \
+  ((unsigned long)(action) << ((state) << 3 | (terminal) << 1))
+
 #ifndef ENCODER_CONST_MEMORY
 #ifdef __AVR__
 #define ENCODER_CONST_MEMORY const __flash
@@ -70,7 +73,8 @@ typedef unsigned char encoder_byte_t;
 enum encoder_terminal
 {
   ENCODER_TERMINAL_A = (1 << 0),
-  ENCODER_TERMINAL_B = (1 << 1)
+  ENCODER_TERMINAL_B = (1 << 1),
+  ENCODER_TERMINAL_Z = (1 << 2)
 };
 
 enum encoder_action
@@ -80,8 +84,24 @@ enum encoder_action
   ENCODER_ACTION_TURN_CCW = 2
 };
 
+/*
+ * The `*_edges_tt()` functions return the terminal edges that must be
+ * observed next, given the state of a `_tt` encoder and the current level
+ * of the terminals. Edges that are not returned can be masked until the
+ * next update without changing the generated actions.
+ */
+enum encoder_edge
+{
+  ENCODER_EDGE_A_RISING = (1 << 0),
+  ENCODER_EDGE_B_RISING = (1 << 1),
+  ENCODER_EDGE_A_FALLING = (1 << 2),
+  ENCODER_EDGE_B_FALLING = (1 << 3)
+};
+
 typedef encoder_byte_t encoder_state;
 
+typedef long encoder_position_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -91,6 +111,24 @@ extern "C"
   encoder_internal_update_tt(encoder_state* s, encoder_fast_byte_t terminal,
                              encoder_byte_t ENCODER_CONST_MEMORY table[][4]);
 
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_internal_edges_tt(encoder_state const* s,
+                            encoder_fast_byte_t terminal,
+                            encoder_byte_t ENCODER_CONST_MEMORY table[])
+  {
+    encoder_fast_byte_t const pins = table[*s];
+    return (encoder_fast_byte_t)((pins & ~terminal) | (pins & terminal) << 2);
+  }
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_internal_update_imm(encoder_state* s, encoder_fast_byte_t terminal,
+                              unsigned long table)
+  {
+    encoder_fast_byte_t shift = (encoder_fast_byte_t)(*s << 3 | terminal << 1);
+    *s = terminal;
+    return (enum encoder_action)((table >> shift) & 0x3);
+  }
+
 #ifdef __cplusplus
 }
 #endif
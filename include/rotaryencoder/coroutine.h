@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_COROUTINE_H
+#define INCLUDE_ROTARYENCODER_COROUTINE_H
+
+#if !defined(__cplusplus) || __cplusplus < 202002L ||                          \
+    !defined(__cpp_impl_coroutine)
+#error "rotaryencoder/coroutine.h requires a C++20 compiler with coroutines"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+
+#include <rotaryencoder/common.h>
+
+/*
+ * Awaiting encoder steps from C++20 coroutines:
+ *
+ *   rotaryencoder::step_scheduler sched;
+ *   rotaryencoder::awaitable_encoder<debounced_encoder_full_step> knob(sched);
+ *
+ *   rotaryencoder::step_task volume(...)
+ *   {
+ *     for (;;)
+ *     {
+ *       auto step = co_await knob.next_step();
+ *       ...
+ *     }
+ *   }
+ *
+ *   {
+ *     rotaryencoder::frame_pool::use use(pool);
+ *     volume(...);
+ *   }
+ *
+ *   // in the scheduler thread
+ *   knob.update(terminal);
+ *   sched.run();
+ *
+ * When an update of the encoder generates an action, all coroutines
+ * waiting for a step of that encoder are handed the action and queued on
+ * the scheduler, which resumes them in a batch when run() is called.
+ * Resuming them from run() rather than from update() means a coroutine can
+ * await the next step of the same encoder right away. Actions decoded
+ * while no coroutine is waiting are not queued, but are still returned by
+ * update().
+ *
+ * The state of each waiting coroutine is kept in its own frame, so an
+ * await never allocates. Coroutine frames of `step_task` are allocated
+ * from a `frame_pool` while it is in use by the calling thread, and on the
+ * heap otherwise.
+ *
+ * Encoders, scheduler and pools must be used from a single thread, and
+ * must outlive all coroutines using them.
+ */
+
+namespace rotaryencoder
+{
+
+/*
+ * A pool of fixed-size blocks for coroutine frames, using `memory` of
+ * `blocks` blocks of `block_size` bytes each. The block size must be a
+ * multiple of alignof(std::max_align_t).
+ */
+class frame_pool
+{
+ public:
+  frame_pool(void* memory, std::size_t block_size, std::size_t blocks)
+    : free_(nullptr)
+    , block_size_(block_size)
+  {
+    char* p = static_cast<char*>(memory);
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+      deallocate(p + i * block_size);
+    }
+  }
+
+  frame_pool(frame_pool const&) = delete;
+  frame_pool& operator=(frame_pool const&) = delete;
+
+  /*
+   * Returns nullptr if `size` exceeds the block size or all blocks are in
+   * use.
+   */
+  void* allocate(std::size_t size) noexcept
+  {
+    block* b = free_;
+
+    if (size > block_size_ || !b)
+    {
+      return nullptr;
+    }
+
+    free_ = b->next;
+
+    return b;
+  }
+
+  void deallocate(void* p) noexcept
+  {
+    block* b = ::new (p) block;
+    b->next = free_;
+    free_ = b;
+  }
+
+  std::size_t block_size() const noexcept { return block_size_; }
+
+  /*
+   * While a `use` object exists, the frames of coroutines started by the
+   * current thread are allocated from its pool.
+   */
+  class use
+  {
+   public:
+    explicit use(frame_pool& pool) noexcept
+      : prev_(current_)
+    {
+      current_ = &pool;
+    }
+
+    ~use() { current_ = prev_; }
+
+    use(use const&) = delete;
+    use& operator=(use const&) = delete;
+
+   private:
+    frame_pool* prev_;
+  };
+
+  static frame_pool* current() noexcept { return current_; }
+
+ private:
+  struct block
+  {
+    block* next;
+  };
+
+  static inline thread_local frame_pool* current_ = nullptr;
+
+  block* free_;
+  std::size_t block_size_;
+};
+
+template <std::size_t BlockSize, std::size_t Blocks>
+class static_frame_pool : public frame_pool
+{
+ public:
+  static_frame_pool()
+    : frame_pool(storage_, BlockSize, Blocks)
+  {
+  }
+
+ private:
+  static_assert(BlockSize % alignof(std::max_align_t) == 0,
+                "block size must be a multiple of the maximum alignment");
+
+  alignas(std::max_align_t) unsigned char storage_[BlockSize * Blocks];
+};
+
+/*
+ * The return type of fire-and-forget coroutines: they start running when
+ * called, and their frame is released when they return. If the frame
+ * can't be allocated, e.g. as the pool is exhausted or its blocks are too
+ * small, the coroutine isn't started and valid() returns false.
+ */
+class step_task
+{
+ public:
+  struct promise_type
+  {
+    static void* operator new(std::size_t size) noexcept
+    {
+      frame_pool* const pool = frame_pool::current();
+      void* const p = pool ? pool->allocate(size + header_size)
+                           : ::operator new(size + header_size, std::nothrow);
+
+      return p ? init(p, pool) : nullptr;
+    }
+
+    static void operator delete(void* p) noexcept
+    {
+      void* const block = static_cast<char*>(p) - header_size;
+      frame_pool* const pool = *static_cast<frame_pool**>(block);
+
+      if (pool)
+      {
+        pool->deallocate(block);
+      }
+      else
+      {
+        ::operator delete(block);
+      }
+    }
+
+    static step_task get_return_object_on_allocation_failure() noexcept
+    {
+      return step_task(false);
+    }
+
+    step_task get_return_object() noexcept { return step_task(true); }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+
+   private:
+    /* the pool the frame was allocated from precedes the frame */
+    static constexpr std::size_t header_size = alignof(std::max_align_t);
+
+    static void* init(void* block, frame_pool* pool) noexcept
+    {
+      *static_cast<frame_pool**>(block) = pool;
+      return static_cast<char*>(block) + header_size;
+    }
+  };
+
+  bool valid() const noexcept { return valid_; }
+
+ private:
+  explicit step_task(bool valid)
+    : valid_(valid)
+  {
+  }
+
+  bool valid_;
+};
+
+class step_scheduler;
+
+/*
+ * A coroutine waiting for a step, linked into the list of its encoder and
+ * then of the scheduler.
+ */
+class step_waiter
+{
+ public:
+  bool await_ready() const noexcept { return false; }
+  enum ::encoder_action await_resume() const noexcept { return action_; }
+
+ protected:
+  friend class step_scheduler;
+  friend class step_waiter_list;
+
+  template <typename Encoder>
+  friend class awaitable_encoder;
+
+  step_waiter* next_ = nullptr;
+  std::coroutine_handle<> handle_;
+  enum ::encoder_action action_ = ENCODER_ACTION_NONE;
+};
+
+/*
+ * A singly linked list of waiters that can be appended to in constant time.
+ */
+class step_waiter_list
+{
+ public:
+  bool empty() const noexcept { return !head_; }
+
+  void push_back(step_waiter* w) noexcept;
+  void splice(step_waiter_list& other) noexcept;
+
+ private:
+  friend class step_scheduler;
+
+  template <typename Encoder>
+  friend class awaitable_encoder;
+
+  step_waiter* head_ = nullptr;
+  step_waiter* tail_ = nullptr;
+};
+
+class step_scheduler
+{
+ public:
+  step_scheduler() = default;
+  step_scheduler(step_scheduler const&) = delete;
+  step_scheduler& operator=(step_scheduler const&) = delete;
+
+  void schedule(step_waiter_list& waiters) noexcept { ready_.splice(waiters); }
+
+  bool empty() const noexcept { return ready_.empty(); }
+
+  /*
+   * Resume all coroutines that have been handed a step since the last call.
+   * Coroutines handed a step while they run are resumed by the next call.
+   * Returns the number of coroutines resumed.
+   */
+  std::size_t run()
+  {
+    step_waiter_list batch;
+    std::size_t count = 0;
+
+    batch.splice(ready_);
+
+    for (step_waiter* w = batch.head_; w;)
+    {
+      /* the waiter lives in the frame, which may be gone after resuming */
+      step_waiter* const next = w->next_;
+      w->handle_.resume();
+      w = next;
+      ++count;
+    }
+
+    return count;
+  }
+
+ private:
+  step_waiter_list ready_;
+};
+
+inline void step_waiter_list::push_back(step_waiter* w) noexcept
+{
+  w->next_ = nullptr;
+
+  if (tail_)
+  {
+    tail_->next_ = w;
+  }
+  else
+  {
+    head_ = w;
+  }
+
+  tail_ = w;
+}
+
+inline void step_waiter_list::splice(step_waiter_list& other) noexcept
+{
+  if (other.head_)
+  {
+    if (tail_)
+    {
+      tail_->next_ = other.head_;
+    }
+    else
+    {
+      head_ = other.head_;
+    }
+
+    tail_ = other.tail_;
+    other.head_ = other.tail_ = nullptr;
+  }
+}
+
+/*
+ * Wraps any of the encoder classes, e.g. debounced_encoder_full_step_tt,
+ * and lets coroutines await its steps.
+ */
+template <typename Encoder>
+class awaitable_encoder
+{
+ public:
+  class step_awaiter : public step_waiter
+  {
+   public:
+    explicit step_awaiter(awaitable_encoder& enc) noexcept
+      : enc_(enc)
+    {
+    }
+
+    void await_suspend(std::coroutine_handle<> h) noexcept
+    {
+      handle_ = h;
+      enc_.waiting_.push_back(this);
+    }
+
+   private:
+    awaitable_encoder& enc_;
+  };
+
+  explicit awaitable_encoder(step_scheduler& sched)
+    : sched_(sched)
+  {
+  }
+
+  awaitable_encoder(step_scheduler& sched, ::encoder_fast_byte_t terminal)
+    : enc_(terminal)
+    , sched_(sched)
+  {
+  }
+
+  awaitable_encoder(awaitable_encoder const&) = delete;
+  awaitable_encoder& operator=(awaitable_encoder const&) = delete;
+
+  void init(::encoder_fast_byte_t terminal) { enc_.init(terminal); }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    enum ::encoder_action const action = enc_.update(terminal);
+
+    if (action != ENCODER_ACTION_NONE && !waiting_.empty())
+    {
+      for (step_waiter* w = waiting_.head_; w; w = w->next_)
+      {
+        w->action_ = action;
+      }
+
+      sched_.schedule(waiting_);
+    }
+
+    return action;
+  }
+
+  /*
+   * Returns an awaitable that resumes the awaiting coroutine with the next
+   * action of the encoder.
+   */
+  step_awaiter next_step() noexcept { return step_awaiter(*this); }
+
+  bool waiting() const noexcept { return !waiting_.empty(); }
+
+  Encoder& encoder() noexcept { return enc_; }
+
+ private:
+  Encoder enc_;
+  step_scheduler& sched_;
+  step_waiter_list waiting_;
+};
+
+}
+
+#endif
@@ -32,8 +32,20 @@ extern "C"
 
   extern ENCODER_CONST_MEMORY encoder_byte_t
       encoder_debounced_full_step_table[7][4];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_debounced_full_step_edges_table[7];
   extern ENCODER_CONST_MEMORY encoder_byte_t
       encoder_debounced_half_step_table[6][4];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_debounced_half_step_edges_table[6];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_debounced_full_step_recovering_table[13][4];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_debounced_full_step_recovering_edges_table[13];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_debounced_half_step_recovering_table[10][4];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_debounced_half_step_recovering_edges_table[10];
 
   static ENCODER_INLINE void
   encoder_debounced_full_step_init(encoder_state* s, encoder_byte_t terminal)
@@ -60,6 +72,18 @@ extern "C"
                                       encoder_debounced_full_step_table);
   }
 
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_debounced_full_step_edges_tt(encoder_state const* s,
+                                       encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_edges_tt(s, terminal,
+                                     encoder_debounced_full_step_edges_table);
+  }
+
+  enum encoder_action
+  encoder_debounced_full_step_update_branchless(encoder_state* s,
+                                               encoder_fast_byte_t terminal);
+
   enum encoder_action
   encoder_debounced_half_step_update(encoder_state* s,
                                      encoder_fast_byte_t terminal);
@@ -72,6 +96,80 @@ extern "C"
                                       encoder_debounced_half_step_table);
   }
 
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_debounced_half_step_edges_tt(encoder_state const* s,
+                                       encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_edges_tt(s, terminal,
+                                     encoder_debounced_half_step_edges_table);
+  }
+
+  enum encoder_action
+  encoder_debounced_half_step_update_branchless(encoder_state* s,
+                                               encoder_fast_byte_t terminal);
+
+  /*
+   * The "recovering" variants behave exactly like their counterparts above,
+   * except that they remember the direction of the last transition. If a
+   * single transition is missed (e.g. 00 -> 11), they assume the encoder kept
+   * turning in that direction instead of discarding the transition.
+   */
+
+  static ENCODER_INLINE void
+  encoder_debounced_full_step_recovering_init(encoder_state* s,
+                                              encoder_byte_t terminal)
+  {
+    (void)terminal;
+    *s = 0x3;
+  }
+
+  static ENCODER_INLINE void
+  encoder_debounced_half_step_recovering_init(encoder_state* s,
+                                              encoder_byte_t terminal)
+  {
+    *s = terminal == 0 ? 0x0 : 0x3;
+  }
+
+  enum encoder_action
+  encoder_debounced_full_step_recovering_update(encoder_state* s,
+                                                encoder_fast_byte_t terminal);
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_debounced_full_step_recovering_update_tt(encoder_state* s,
+                                                   encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_update_tt(
+        s, terminal, encoder_debounced_full_step_recovering_table);
+  }
+
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_debounced_full_step_recovering_edges_tt(encoder_state const* s,
+                                                  encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_edges_tt(
+        s, terminal, encoder_debounced_full_step_recovering_edges_table);
+  }
+
+  enum encoder_action
+  encoder_debounced_half_step_recovering_update(encoder_state* s,
+                                                encoder_fast_byte_t terminal);
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_debounced_half_step_recovering_update_tt(encoder_state* s,
+                                                   encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_update_tt(
+        s, terminal, encoder_debounced_half_step_recovering_table);
+  }
+
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_debounced_half_step_recovering_edges_tt(encoder_state const* s,
+                                                  encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_edges_tt(
+        s, terminal, encoder_debounced_half_step_recovering_edges_table);
+  }
+
 #ifdef __cplusplus
 }
 #endif
@@ -132,6 +230,39 @@ class debounced_encoder_full_step_tt
     return ::encoder_debounced_full_step_update_tt(&s_, terminal);
   }
 
+  ::encoder_fast_byte_t edges(::encoder_fast_byte_t terminal) const
+  {
+    return ::encoder_debounced_full_step_edges_tt(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class debounced_encoder_full_step_branchless
+{
+ public:
+#if __cplusplus >= 201103L
+  debounced_encoder_full_step_branchless() = default;
+#else
+  debounced_encoder_full_step_branchless() {}
+#endif
+
+  debounced_encoder_full_step_branchless(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_debounced_full_step_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_debounced_full_step_update_branchless(&s_, terminal);
+  }
+
  private:
   encoder_state s_;
 };
@@ -188,6 +319,161 @@ class debounced_encoder_half_step_tt
     return ::encoder_debounced_half_step_update_tt(&s_, terminal);
   }
 
+  ::encoder_fast_byte_t edges(::encoder_fast_byte_t terminal) const
+  {
+    return ::encoder_debounced_half_step_edges_tt(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class debounced_encoder_half_step_branchless
+{
+ public:
+#if __cplusplus >= 201103L
+  debounced_encoder_half_step_branchless() = default;
+#else
+  debounced_encoder_half_step_branchless() {}
+#endif
+
+  debounced_encoder_half_step_branchless(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_debounced_half_step_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_debounced_half_step_update_branchless(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class debounced_encoder_full_step_recovering
+{
+ public:
+#if __cplusplus >= 201103L
+  debounced_encoder_full_step_recovering() = default;
+#else
+  debounced_encoder_full_step_recovering() {}
+#endif
+
+  debounced_encoder_full_step_recovering(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_debounced_full_step_recovering_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_debounced_full_step_recovering_update(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class debounced_encoder_full_step_recovering_tt
+{
+ public:
+#if __cplusplus >= 201103L
+  debounced_encoder_full_step_recovering_tt() = default;
+#else
+  debounced_encoder_full_step_recovering_tt() {}
+#endif
+
+  debounced_encoder_full_step_recovering_tt(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_debounced_full_step_recovering_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_debounced_full_step_recovering_update_tt(&s_, terminal);
+  }
+
+  ::encoder_fast_byte_t edges(::encoder_fast_byte_t terminal) const
+  {
+    return ::encoder_debounced_full_step_recovering_edges_tt(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class debounced_encoder_half_step_recovering
+{
+ public:
+#if __cplusplus >= 201103L
+  debounced_encoder_half_step_recovering() = default;
+#else
+  debounced_encoder_half_step_recovering() {}
+#endif
+
+  debounced_encoder_half_step_recovering(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_debounced_half_step_recovering_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_debounced_half_step_recovering_update(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class debounced_encoder_half_step_recovering_tt
+{
+ public:
+#if __cplusplus >= 201103L
+  debounced_encoder_half_step_recovering_tt() = default;
+#else
+  debounced_encoder_half_step_recovering_tt() {}
+#endif
+
+  debounced_encoder_half_step_recovering_tt(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_debounced_half_step_recovering_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_debounced_half_step_recovering_update_tt(&s_, terminal);
+  }
+
+  ::encoder_fast_byte_t edges(::encoder_fast_byte_t terminal) const
+  {
+    return ::encoder_debounced_half_step_recovering_edges_tt(&s_, terminal);
+  }
+
  private:
   encoder_state s_;
 };
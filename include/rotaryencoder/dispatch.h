@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_DISPATCH_H
+#define INCLUDE_ROTARYENCODER_DISPATCH_H
+
+#include <rotaryencoder/common.h>
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/simple_encoder.h>
+
+/*
+ * Running code for each action directly from the transition, instead of
+ * switching on the returned action:
+ *
+ *   ENCODER_DISPATCH_TT(&es, terminal, encoder_debounced_full_step_table,
+ *                       ++encoder_value, --encoder_value);
+ *
+ * The macro performs the update of a `_tt` encoder and tests the action
+ * bits of the table entry directly, so the generated code is the table
+ * lookup followed by the two handler statements, without decoding the
+ * action into an enum first. The handlers may be any statements. The
+ * arguments are evaluated once, except for the handlers, which are
+ * evaluated at most once.
+ */
+
+#define ENCODER_DISPATCH_TT(s, terminal, table, on_cw, on_ccw)                 \
+  do                                                                           \
+  {                                                                            \
+    encoder_state* const encoder_dispatch_s_ = (s);                            \
+    encoder_fast_byte_t const encoder_dispatch_next_ =                         \
+        (table)[*encoder_dispatch_s_][(terminal)];                             \
+    *encoder_dispatch_s_ =                                                     \
+        (encoder_state)(encoder_dispatch_next_ &                               \
+                        ENCODER_INTERNAL_STATE_MASK_TT);                       \
+    if (encoder_dispatch_next_ &                                               \
+        (ENCODER_ACTION_TURN_CW << ENCODER_INTERNAL_ACTION_SHIFT_TT))          \
+    {                                                                          \
+      on_cw;                                                                   \
+    }                                                                          \
+    else if (encoder_dispatch_next_ &                                          \
+             (ENCODER_ACTION_TURN_CCW << ENCODER_INTERNAL_ACTION_SHIFT_TT))    \
+    {                                                                          \
+      on_ccw;                                                                  \
+    }                                                                          \
+  } while (0)
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+
+namespace rotaryencoder
+{
+
+/*
+ * Initialisation and transition table of the `_tt` classes.
+ */
+template <typename Encoder>
+struct encoder_tt_traits
+{
+};
+
+#define ROTARYENCODER_INTERNAL_TT_TRAITS(cls, flavour)                         \
+  template <>                                                                  \
+  struct encoder_tt_traits<cls>                                                \
+  {                                                                            \
+    static void init(::encoder_state* s, ::encoder_fast_byte_t terminal)       \
+    {                                                                          \
+      ::encoder_##flavour##_init(s, static_cast<::encoder_byte_t>(terminal));  \
+    }                                                                          \
+                                                                               \
+    static ::encoder_byte_t ENCODER_CONST_MEMORY (*table())[4]                 \
+    {                                                                          \
+      return ::encoder_##flavour##_table;                                      \
+    }                                                                          \
+  };
+
+ROTARYENCODER_INTERNAL_TT_TRAITS(simple_encoder_full_step_tt, simple_full_step)
+ROTARYENCODER_INTERNAL_TT_TRAITS(simple_encoder_half_step_tt, simple_half_step)
+ROTARYENCODER_INTERNAL_TT_TRAITS(simple_encoder_quarter_step_tt,
+                                 simple_quarter_step)
+ROTARYENCODER_INTERNAL_TT_TRAITS(debounced_encoder_full_step_tt,
+                                 debounced_full_step)
+ROTARYENCODER_INTERNAL_TT_TRAITS(debounced_encoder_half_step_tt,
+                                 debounced_half_step)
+ROTARYENCODER_INTERNAL_TT_TRAITS(debounced_encoder_full_step_recovering_tt,
+                                 debounced_full_step_recovering)
+ROTARYENCODER_INTERNAL_TT_TRAITS(debounced_encoder_half_step_recovering_tt,
+                                 debounced_half_step_recovering)
+
+#undef ROTARYENCODER_INTERNAL_TT_TRAITS
+
+namespace detail
+{
+
+template <typename...>
+struct make_void
+{
+  typedef void type;
+};
+
+/* any encoder class: switch on the returned action */
+template <typename Encoder, typename = void>
+class dispatch_state
+{
+ public:
+  void init(::encoder_fast_byte_t terminal) { enc_.init(terminal); }
+
+  template <typename OnCW, typename OnCCW>
+  enum ::encoder_action
+  update(::encoder_fast_byte_t terminal, OnCW& on_cw, OnCCW& on_ccw)
+  {
+    enum ::encoder_action const action = enc_.update(terminal);
+
+    if (action == ENCODER_ACTION_TURN_CW)
+    {
+      on_cw();
+    }
+    else if (action == ENCODER_ACTION_TURN_CCW)
+    {
+      on_ccw();
+    }
+
+    return action;
+  }
+
+ private:
+  Encoder enc_;
+};
+
+/* the `_tt` classes: test the action bits of the table entry */
+template <typename Encoder>
+class dispatch_state<
+    Encoder,
+    typename make_void<decltype(encoder_tt_traits<Encoder>::table())>::type>
+{
+ public:
+  void init(::encoder_fast_byte_t terminal)
+  {
+    encoder_tt_traits<Encoder>::init(&s_, terminal);
+  }
+
+  template <typename OnCW, typename OnCCW>
+  enum ::encoder_action
+  update(::encoder_fast_byte_t terminal, OnCW& on_cw, OnCCW& on_ccw)
+  {
+    ::encoder_fast_byte_t const next =
+        encoder_tt_traits<Encoder>::table()[s_][terminal];
+
+    s_ = static_cast<::encoder_state>(next & ENCODER_INTERNAL_STATE_MASK_TT);
+
+    if (next & (ENCODER_ACTION_TURN_CW << ENCODER_INTERNAL_ACTION_SHIFT_TT))
+    {
+      on_cw();
+    }
+    else if (next &
+             (ENCODER_ACTION_TURN_CCW << ENCODER_INTERNAL_ACTION_SHIFT_TT))
+    {
+      on_ccw();
+    }
+
+    return static_cast<enum ::encoder_action>(
+        next >> ENCODER_INTERNAL_ACTION_SHIFT_TT);
+  }
+
+ private:
+  ::encoder_state s_;
+};
+
+}
+
+/*
+ * An encoder that calls `OnCW` or `OnCCW` for each action. The handlers
+ * are part of the type, e.g. lambdas or function objects, so they are
+ * inlined into update() rather than called through a pointer. For the
+ * `_tt` classes, the handlers are selected by the action bits of the
+ * table entry, like ENCODER_DISPATCH_TT() does.
+ */
+template <typename Encoder, typename OnCW, typename OnCCW>
+class dispatching_encoder
+{
+ public:
+  dispatching_encoder(OnCW on_cw, OnCCW on_ccw)
+    : on_cw_(on_cw)
+    , on_ccw_(on_ccw)
+  {
+  }
+
+  dispatching_encoder(::encoder_fast_byte_t terminal, OnCW on_cw,
+                      OnCCW on_ccw)
+    : on_cw_(on_cw)
+    , on_ccw_(on_ccw)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal) { state_.init(terminal); }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return state_.update(terminal, on_cw_, on_ccw_);
+  }
+
+ private:
+  detail::dispatch_state<Encoder> state_;
+  OnCW on_cw_;
+  OnCCW on_ccw_;
+};
+
+template <typename Encoder, typename OnCW, typename OnCCW>
+dispatching_encoder<Encoder, OnCW, OnCCW>
+make_dispatching_encoder(::encoder_fast_byte_t terminal, OnCW on_cw,
+                         OnCCW on_ccw)
+{
+  return dispatching_encoder<Encoder, OnCW, OnCCW>(terminal, on_cw, on_ccw);
+}
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_FUSED_H
+#define INCLUDE_ROTARYENCODER_FUSED_H
+
+#include <rotaryencoder/common.h>
+
+/*
+ * A `_tt` state and a position fused into a single word: the state lives
+ * in the low ENCODER_INTERNAL_FUSED_SHIFT bits and the signed position in
+ * the bits above it. The fused tables hold, for every state and terminal
+ * level, the difference to the next word, so a single load, add and store
+ * performs both the transition and the count update:
+ *
+ *   encoder_fused_update(&word, terminal,
+ *                        encoder_debounced_full_step_fused_table);
+ *
+ * The position wraps around modulo 2^(N - 4) for an N-bit word, i.e. it
+ * covers -2048 to 2047 with a 16-bit `int`. Define ENCODER_FUSED_TYPE to
+ * a wider unsigned type, both when building the library and when using
+ * it, if that isn't enough.
+ */
+
+#ifndef ENCODER_FUSED_TYPE
+#define ENCODER_FUSED_TYPE unsigned int
+#endif
+
+typedef ENCODER_FUSED_TYPE encoder_fused_t;
+
+#define ENCODER_INTERNAL_FUSED_SHIFT ENCODER_INTERNAL_ACTION_SHIFT_TT
+
+#define ENCODER_INTERNAL_FUSED_STEP(e)                                         \
+  ((e) >> ENCODER_INTERNAL_ACTION_SHIFT_TT == ENCODER_ACTION_TURN_CW           \
+       ? (encoder_fused_t)1 << ENCODER_INTERNAL_FUSED_SHIFT                    \
+   : (e) >> ENCODER_INTERNAL_ACTION_SHIFT_TT == ENCODER_ACTION_TURN_CCW        \
+       ? (encoder_fused_t)((encoder_fused_t)0 -                                \
+                           ((encoder_fused_t)1                                 \
+                            << ENCODER_INTERNAL_FUSED_SHIFT))                  \
+       : (encoder_fused_t)0)
+
+/*
+ * The fused table entry for the `_tt` table entry `e` in the row of
+ * state `s`.
+ */
+#define ENCODER_INTERNAL_FUSED(s, e)                                           \
+  (encoder_fused_t)((encoder_fused_t)((e) & ENCODER_INTERNAL_STATE_MASK_TT) -  \
+                    (encoder_fused_t)(s) + ENCODER_INTERNAL_FUSED_STEP(e))
+
+#define ENCODER_INTERNAL_FUSED_ROW(s, e00, e01, e10, e11)                      \
+  {                                                                            \
+    ENCODER_INTERNAL_FUSED(s, e00), ENCODER_INTERNAL_FUSED(s, e01),            \
+        ENCODER_INTERNAL_FUSED(s, e10), ENCODER_INTERNAL_FUSED(s, e11)         \
+  }
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  extern ENCODER_CONST_MEMORY encoder_fused_t
+      encoder_debounced_full_step_fused_table[7][4];
+  extern ENCODER_CONST_MEMORY encoder_fused_t
+      encoder_debounced_half_step_fused_table[6][4];
+  extern ENCODER_CONST_MEMORY encoder_fused_t
+      encoder_debounced_full_step_recovering_fused_table[13][4];
+  extern ENCODER_CONST_MEMORY encoder_fused_t
+      encoder_debounced_half_step_recovering_fused_table[10][4];
+  extern ENCODER_CONST_MEMORY encoder_fused_t
+      encoder_simple_full_step_fused_table[4][4];
+  extern ENCODER_CONST_MEMORY encoder_fused_t
+      encoder_simple_half_step_fused_table[4][4];
+  extern ENCODER_CONST_MEMORY encoder_fused_t
+      encoder_simple_quarter_step_fused_table[4][4];
+
+  /*
+   * Initialises the word from a state returned by one of the `_tt`
+   * `init` functions, with the position at zero.
+   */
+  static ENCODER_INLINE void encoder_fused_init(encoder_fused_t* w,
+                                                encoder_state s)
+  {
+    *w = s;
+  }
+
+  static ENCODER_INLINE void
+  encoder_fused_update(encoder_fused_t* w, encoder_fast_byte_t terminal,
+                       encoder_fused_t ENCODER_CONST_MEMORY table[][4])
+  {
+    *w += table[*w & ENCODER_INTERNAL_STATE_MASK_TT][terminal];
+  }
+
+  static ENCODER_INLINE encoder_state encoder_fused_state(encoder_fused_t w)
+  {
+    return (encoder_state)(w & ENCODER_INTERNAL_STATE_MASK_TT);
+  }
+
+  static ENCODER_INLINE encoder_position_t
+  encoder_fused_position(encoder_fused_t w)
+  {
+    encoder_fused_t const sign = (encoder_fused_t)~(
+        (encoder_fused_t)~(encoder_fused_t)0 >> 1);
+    return (w & sign)
+               ? -(encoder_position_t)((encoder_fused_t)~w >>
+                                       ENCODER_INTERNAL_FUSED_SHIFT) -
+                     1
+               : (encoder_position_t)(w >> ENCODER_INTERNAL_FUSED_SHIFT);
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_ROTARYENCODER_FUSED_H */
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_INDEX_ENCODER_H
+#define INCLUDE_ROTARYENCODER_INDEX_ENCODER_H
+
+#include <rotaryencoder/common.h>
+
+/*
+ * Support for the index (Z) channel of incremental encoders.
+ *
+ * The index state keeps track of the position, using the actions of any of
+ * the A/B state machines, and latches the position whenever an index pulse
+ * is seen. The index pulse is gated to the 11 state of the A/B terminals,
+ * so the latched position is the same regardless of the direction in which
+ * the index is passed.
+ *
+ * Only the A/B bits of the terminal value must be passed to the A/B state
+ * machine, whereas encoder_index_update() expects all three bits:
+ *
+ *   action = encoder_debounced_full_step_update(&es, terminal & 0x3);
+ *   encoder_index_update(&is, terminal, action);
+ */
+
+#define ENCODER_INDEX_GATE_MASK 0x01
+#define ENCODER_INDEX_LATCHED 0x02
+#define ENCODER_INDEX_HOMING 0x04
+#define ENCODER_INDEX_HOMING_CONTINUOUS 0x08
+#define ENCODER_INDEX_EVENT 0x10
+
+typedef struct encoder_index_state
+{
+  encoder_position_t position;
+  encoder_position_t index_position;
+  encoder_position_t home_position;
+  encoder_byte_t flags;
+} encoder_index_state;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  extern ENCODER_CONST_MEMORY encoder_byte_t encoder_index_gate_table[2][8];
+
+  static ENCODER_INLINE void encoder_index_init(encoder_index_state* s)
+  {
+    s->position = 0;
+    s->index_position = 0;
+    s->home_position = 0;
+    s->flags = 0;
+  }
+
+  /*
+   * Apply `action` to the position and process the index terminal.
+   * Returns non-zero if an index pulse was seen.
+   */
+  encoder_fast_byte_t encoder_index_update(encoder_index_state* s,
+                                           encoder_fast_byte_t terminal,
+                                           enum encoder_action action);
+
+  /*
+   * Set the position to `position` at the next index pulse. If `continuous`
+   * is non-zero, do this at every index pulse.
+   */
+  static ENCODER_INLINE void encoder_index_home(encoder_index_state* s,
+                                                encoder_position_t position,
+                                                encoder_fast_byte_t continuous)
+  {
+    s->home_position = position;
+    s->flags = (s->flags & ~ENCODER_INDEX_HOMING_CONTINUOUS) |
+               ENCODER_INDEX_HOMING |
+               (continuous ? ENCODER_INDEX_HOMING_CONTINUOUS : 0);
+  }
+
+  /*
+   * Shift the position so that the last latched index position becomes
+   * `position`.
+   */
+  static ENCODER_INLINE void encoder_index_sync(encoder_index_state* s,
+                                                encoder_position_t position)
+  {
+    s->position += position - s->index_position;
+    s->index_position = position;
+  }
+
+  /*
+   * Returns non-zero if an index pulse has been seen since the last call.
+   */
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_index_latched(encoder_index_state* s)
+  {
+    encoder_fast_byte_t const latched = s->flags & ENCODER_INDEX_LATCHED;
+    s->flags &= ~ENCODER_INDEX_LATCHED;
+    return latched;
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace rotaryencoder
+{
+
+template <typename Encoder>
+class index_encoder
+{
+ public:
+  index_encoder() { ::encoder_index_init(&s_); }
+
+  index_encoder(::encoder_fast_byte_t terminal) { init(terminal); }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    enc_.init(terminal & (ENCODER_TERMINAL_A | ENCODER_TERMINAL_B));
+    ::encoder_index_init(&s_);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    enum ::encoder_action action =
+        enc_.update(terminal & (ENCODER_TERMINAL_A | ENCODER_TERMINAL_B));
+    ::encoder_index_update(&s_, terminal, action);
+    return action;
+  }
+
+  ::encoder_position_t position() const { return s_.position; }
+
+  ::encoder_position_t index_position() const { return s_.index_position; }
+
+  bool latched() { return ::encoder_index_latched(&s_) != 0; }
+
+  void home(::encoder_position_t position, bool continuous = false)
+  {
+    ::encoder_index_home(&s_, position, continuous);
+  }
+
+  void sync(::encoder_position_t position)
+  {
+    ::encoder_index_sync(&s_, position);
+  }
+
+ private:
+  Encoder enc_;
+  encoder_index_state s_;
+};
+
+}
+#endif
+
+#endif
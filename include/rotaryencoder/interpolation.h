@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_INTERPOLATION_H
+#define INCLUDE_ROTARYENCODER_INTERPOLATION_H
+
+#include <rotaryencoder/common.h>
+
+/*
+ * Interpolation of sin/cos encoders.
+ *
+ * The A (cos) and B (sin) signals are thresholded with hysteresis around
+ * their offsets and fed to the quarter-step state machine, which provides
+ * a coarse count that is robust against noise. The angle of the signals,
+ * computed using a fixed-point CORDIC, adds the position within the current
+ * quarter step.
+ *
+ * Angles are in units of 1/65536 of a signal period, so there are 16384
+ * units per quarter step. The interpolated position uses the same unit.
+ * With a 32-bit encoder_position_t, it covers +/-32768 signal periods;
+ * beyond that, `count` (in quarter steps) can be used to extend the range.
+ *
+ * Only integer arithmetic is used, which makes this suitable for MCUs
+ * without an FPU. Signals must not exceed +/-32767 around their offsets.
+ */
+
+#define ENCODER_CORDIC_ITERATIONS 16
+#define ENCODER_CORDIC_INPUT_SHIFT 13
+
+typedef struct encoder_interpolator
+{
+  encoder_position_t count;
+  int offset_a;
+  int offset_b;
+  int hysteresis;
+  encoder_byte_t terminal;
+  encoder_state state;
+} encoder_interpolator;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  extern ENCODER_CONST_MEMORY long
+      encoder_cordic_table[ENCODER_CORDIC_ITERATIONS];
+
+  /*
+   * Returns the angle of the vector (x, y) in units of 1/65536 of a turn.
+   */
+  unsigned encoder_cordic_atan2(int y, int x);
+
+  /*
+   * Set up the interpolator for signals centered around `offset_a` and
+   * `offset_b`, with the given hysteresis for the coarse count, starting
+   * from the samples `a` and `b`.
+   */
+  void encoder_interpolator_init(encoder_interpolator* ip, int offset_a,
+                                 int offset_b, int hysteresis, int a, int b);
+
+  /*
+   * Process the samples `a` and `b`, given their angle as computed by
+   * encoder_cordic_atan2(). Returns the interpolated position.
+   */
+  encoder_position_t encoder_internal_interpolate(encoder_interpolator* ip,
+                                                  int a, int b,
+                                                  unsigned angle);
+
+  /*
+   * Process the samples `a` and `b` and return the interpolated position.
+   */
+  static ENCODER_INLINE encoder_position_t
+  encoder_interpolator_update(encoder_interpolator* ip, int a, int b)
+  {
+    return encoder_internal_interpolate(
+        ip, a, b,
+        encoder_cordic_atan2(b - ip->offset_b, a - ip->offset_a));
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
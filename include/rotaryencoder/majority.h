@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_MAJORITY_H
+#define INCLUDE_ROTARYENCODER_MAJORITY_H
+
+#include <rotaryencoder/batch.h>
+
+/*
+ * Majority filter for oversampled terminal values.
+ *
+ * Each channel is filtered by counting its high samples over a sliding
+ * window of the last `window` samples (1 to 32). The output goes high when
+ * the count is at least `high`, low when it is less than `low`, and keeps
+ * its level otherwise, so `low` < `high` adds hysteresis on top of the
+ * majority vote. `low` must not be greater than `high`, and `high` must
+ * not be greater than `window`. The output lags the input by about half
+ * the window.
+ *
+ * Samples are packed in the format used by the batch functions, and the
+ * windows of all 32 samples of a word are counted at once using bit-sliced
+ * counters, for both channels in parallel.
+ */
+
+typedef struct encoder_majority
+{
+  uint64_t history;
+  encoder_byte_t window;
+  encoder_byte_t low;
+  encoder_byte_t high;
+  encoder_byte_t terminal;
+} encoder_majority;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Set up a filter with the given window and thresholds. `terminal` is the
+   * initial level of both channels, which is assumed to have been stable
+   * for the whole window.
+   */
+  static ENCODER_INLINE void
+  encoder_majority_init_hysteresis(encoder_majority* m,
+                                   encoder_fast_byte_t window,
+                                   encoder_fast_byte_t low,
+                                   encoder_fast_byte_t high,
+                                   encoder_fast_byte_t terminal)
+  {
+    m->history = (terminal & 3) * UINT64_C(0x5555555555555555);
+    m->window = (encoder_byte_t)window;
+    m->low = (encoder_byte_t)low;
+    m->high = (encoder_byte_t)high;
+    m->terminal = (encoder_byte_t)(terminal & 3);
+  }
+
+  /*
+   * Set up a plain majority filter, which should use an odd `window`.
+   */
+  static ENCODER_INLINE void encoder_majority_init(encoder_majority* m,
+                                                   encoder_fast_byte_t window,
+                                                   encoder_fast_byte_t terminal)
+  {
+    encoder_majority_init_hysteresis(m, window, window / 2 + 1,
+                                     window / 2 + 1, terminal);
+  }
+
+  /*
+   * Filter `words` words of packed samples. `in` and `out` may be the same.
+   */
+  void encoder_majority_filter(encoder_majority* m, uint64_t const* in,
+                               uint64_t* out, size_t words);
+
+  /*
+   * Filter and decode `words` words of packed samples. `s`, `actions` and
+   * the return value are the same as for encoder_batch_update_tt().
+   */
+  encoder_position_t encoder_majority_update_batch_tt(
+      encoder_majority* m, encoder_state* s, uint64_t const* samples,
+      uint64_t* actions, size_t words,
+      encoder_byte_t ENCODER_CONST_MEMORY table[][4]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
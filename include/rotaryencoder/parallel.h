@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_PARALLEL_H
+#define INCLUDE_ROTARYENCODER_PARALLEL_H
+
+#include <rotaryencoder/batch.h>
+
+/*
+ * Parallel batch decoding of many independent streams, e.g. when
+ * reprocessing captured data offline.
+ *
+ * Each job decodes one stream of packed samples, exactly as a single call
+ * to encoder_batch_update_tt() would: `state` is updated, `actions` is
+ * filled if not NULL, and the net step count is stored in `delta`.
+ *
+ * Streams are split into chunks, which are distributed across a pool of
+ * threads that steal chunks from each other when they run out of work, so
+ * a few very long streams don't hold up the others. As the state at the
+ * start of a chunk isn't known until the previous chunk has been decoded,
+ * chunks are decoded speculatively, starting from the initial state of
+ * the job. Once all chunks are done, each chunk is re-decoded from its
+ * actual start state until the state machine converges with the
+ * speculative run, which usually only takes a few samples.
+ */
+
+typedef struct encoder_parallel_job
+{
+  encoder_state* state;
+  uint64_t const* samples;
+  uint64_t* actions;
+  size_t words;
+  encoder_byte_t ENCODER_CONST_MEMORY (*table)[4];
+  encoder_position_t delta;
+} encoder_parallel_job;
+
+typedef struct encoder_parallel_stats
+{
+  uint64_t samples;
+  size_t chunks;
+  size_t steals;
+  size_t resyncs;
+  double seconds;
+  double samples_per_second;
+} encoder_parallel_stats;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Decode `count` jobs using `threads` threads (or one per CPU if zero),
+   * in chunks of about `chunk_words` words (or a default size if zero).
+   * `stats` may be NULL. Returns 0 on success, or -1 if memory couldn't be
+   * allocated, in which case no job has been decoded. If threads can't be
+   * created, the jobs are decoded by fewer threads.
+   */
+  int encoder_parallel_decode(encoder_parallel_job* jobs, size_t count,
+                              unsigned threads, size_t chunk_words,
+                              encoder_parallel_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_QUEUE_H
+#define INCLUDE_ROTARYENCODER_QUEUE_H
+
+#include <stddef.h>
+
+#include <rotaryencoder/common.h>
+
+#if !defined(UINT64_MAX)
+#error "rotaryencoder/queue.h requires a C99 or C++11 compiler"
+#endif
+
+/*
+ * A bounded queue of encoder events from any number of producer threads,
+ * e.g. one per gpiochip or HID device, to a single consumer thread.
+ *
+ * Producers reserve a run of slots for a whole batch of events with a
+ * single compare-and-swap, copy the events and then publish each slot, so
+ * there is no lock and no allocation per event. The memory for all slots
+ * is allocated when the queue is created. When the queue is full, a push
+ * only accepts as many events as there are free slots, leaving it to the
+ * producer to retry, wait or drop the rest.
+ *
+ * The consumer receives the events of each producer in the order they
+ * were pushed, and the batches of different producers in the order their
+ * slots were reserved. A producer that is preempted between reserving and
+ * publishing its slots holds up the consumer at the first of these slots
+ * until it resumes, but never blocks other producers unless the queue
+ * fills up.
+ *
+ * It is part of the host library, which requires C11 atomics.
+ */
+
+typedef struct encoder_event
+{
+  uint64_t timestamp;
+  uint32_t encoder;
+  uint32_t action;
+} encoder_event;
+
+typedef struct encoder_event_queue encoder_event_queue;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Create a queue for at least `capacity` events, which is rounded up to
+   * a power of two. Returns NULL if the memory can't be allocated.
+   */
+  encoder_event_queue* encoder_event_queue_create(size_t capacity);
+
+  void encoder_event_queue_destroy(encoder_event_queue* q);
+
+  size_t encoder_event_queue_capacity(encoder_event_queue const* q);
+
+  /*
+   * Called by any producer: append up to `count` events from `events`.
+   * Returns the number of events appended, which is less than `count` if
+   * the queue is full.
+   */
+  size_t encoder_event_queue_push(encoder_event_queue* q,
+                                  encoder_event const* events, size_t count);
+
+  /*
+   * Called by the consumer: move up to `max` events into `events`. Returns
+   * the number of events moved, which is zero if the queue is empty.
+   */
+  size_t encoder_event_queue_pop(encoder_event_queue* q, encoder_event* events,
+                                 size_t max);
+
+  /*
+   * Append a single action, ignoring ENCODER_ACTION_NONE. Returns zero if
+   * the queue is full.
+   */
+  static ENCODER_INLINE int
+  encoder_event_queue_push_action(encoder_event_queue* q, uint32_t encoder,
+                                  enum encoder_action action,
+                                  uint64_t timestamp)
+  {
+    encoder_event event;
+
+    if (action == ENCODER_ACTION_NONE)
+    {
+      return 1;
+    }
+
+    event.timestamp = timestamp;
+    event.encoder = encoder;
+    event.action = (uint32_t)action;
+
+    return encoder_event_queue_push(q, &event, 1) == 1;
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_RANGES_H
+#define INCLUDE_ROTARYENCODER_RANGES_H
+
+#if !defined(__cplusplus) || __cplusplus < 202002L
+#error "rotaryencoder/ranges.h requires a C++20 compiler"
+#endif
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include <rotaryencoder/batch.h>
+#include <rotaryencoder/dispatch.h>
+
+/*
+ * Range adaptors for lazy decoding of sequences of terminal values:
+ *
+ *   for (auto a : samples | rotaryencoder::views::decode<Encoder>())
+ *     // one action per sample
+ *
+ *   for (auto s : samples | rotaryencoder::views::steps<Encoder>())
+ *     // s.index, s.action and s.position of each step
+ *
+ * `Encoder` is any of the encoder classes. It is initialised with the
+ * first sample, and then updated with every sample including the first,
+ * like a loop that calls init() once and update() for each sample would.
+ * Each call to begin() starts decoding from scratch.
+ *
+ * For the `_tt` classes, `steps` decodes contiguous ranges of byte-sized
+ * terminal values 32 samples at a time using the batch functions, so it
+ * skips stretches without any actions at batch speed. `decode` has to
+ * hand out every action anyway and always decodes sample by sample. The
+ * views are part of the host library, which provides the batch functions.
+ */
+
+namespace rotaryencoder
+{
+
+struct step
+{
+  std::size_t index;
+  enum ::encoder_action action;
+  ::encoder_position_t position;
+};
+
+namespace detail
+{
+
+template <typename V, typename Encoder>
+concept batch_decodable =
+    std::ranges::contiguous_range<V> && std::ranges::sized_range<V> &&
+    std::is_integral_v<std::ranges::range_value_t<V>> &&
+    sizeof(std::ranges::range_value_t<V>) == 1 &&
+    requires { encoder_tt_traits<Encoder>::table(); };
+
+/*
+ * Decodes a contiguous range of terminal values in chunks of 32 samples,
+ * keeping the actions of the current chunk in the batch layout.
+ */
+template <typename Encoder>
+class batch_cursor
+{
+ public:
+  batch_cursor() = default;
+
+  batch_cursor(void const* data, std::size_t size)
+    : data_(static_cast<unsigned char const*>(data))
+    , size_(size)
+  {
+    if (size_ > 0)
+    {
+      encoder_tt_traits<Encoder>::init(&state_, data_[0] & 0x3);
+      load();
+    }
+  }
+
+  std::size_t chunk() const noexcept { return chunk_; }
+  std::size_t size() const noexcept { return size_; }
+  std::uint64_t actions() const noexcept { return actions_; }
+
+  /*
+   * Move to the next chunk. Returns false at the end of the range.
+   */
+  bool next()
+  {
+    chunk_ += 32;
+
+    if (chunk_ >= size_)
+    {
+      chunk_ = size_;
+      actions_ = 0;
+      return false;
+    }
+
+    load();
+
+    return true;
+  }
+
+ private:
+  void load()
+  {
+    unsigned char const* p = data_ + chunk_;
+    std::size_t const n = size_ - chunk_ < 32 ? size_ - chunk_ : 32;
+    std::uint64_t word = 0;
+
+    if (n == 32 && std::endian::native == std::endian::little)
+    {
+      /* gather the low two bits of 8 bytes at a time */
+      for (int i = 0; i < 4; ++i)
+      {
+        std::uint64_t x;
+        std::memcpy(&x, p + 8 * i, sizeof(x));
+        x &= UINT64_C(0x0303030303030303);
+        x = (x | x >> 6) & UINT64_C(0x000F000F000F000F);
+        x = (x | x >> 12) & UINT64_C(0x000000FF000000FF);
+        x = (x | x >> 24) & UINT64_C(0xFFFF);
+        word |= x << (16 * i);
+      }
+    }
+    else
+    {
+      /* repeated samples never cause actions */
+      for (std::size_t i = 0; i < 32; ++i)
+      {
+        word |= static_cast<std::uint64_t>(p[i < n ? i : n - 1] & 0x3)
+                << (2 * i);
+      }
+    }
+
+    ::encoder_batch_update_tt(&state_, &word, &actions_, 1,
+                              encoder_tt_traits<Encoder>::table());
+  }
+
+  unsigned char const* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t chunk_ = 0;
+  std::uint64_t actions_ = 0;
+  ::encoder_state state_ = 0;
+};
+
+template <typename V>
+using iterator_concept_t =
+    std::conditional_t<std::ranges::forward_range<V>, std::forward_iterator_tag,
+                       std::input_iterator_tag>;
+
+}
+
+template <std::ranges::view V, typename Encoder>
+  requires std::ranges::input_range<V>
+class decode_view : public std::ranges::view_interface<decode_view<V, Encoder>>
+{
+ public:
+  /* updates an encoder with each sample */
+  class iterator
+  {
+   public:
+    using iterator_concept = detail::iterator_concept_t<V>;
+    using value_type = enum ::encoder_action;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    iterator(std::ranges::iterator_t<V> it, std::ranges::sentinel_t<V> end)
+      : it_(std::move(it))
+      , end_(std::move(end))
+    {
+      if (it_ != end_)
+      {
+        enc_.init(*it_);
+        action_ = enc_.update(*it_);
+      }
+    }
+
+    value_type operator*() const { return action_; }
+
+    iterator& operator++()
+    {
+      if (++it_ != end_)
+      {
+        action_ = enc_.update(*it_);
+      }
+
+      return *this;
+    }
+
+    void operator++(int) { ++*this; }
+
+    iterator operator++(int)
+      requires std::ranges::forward_range<V>
+    {
+      iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(iterator const& a, iterator const& b)
+      requires std::ranges::forward_range<V>
+    {
+      return a.it_ == b.it_;
+    }
+
+    friend bool operator==(iterator const& a, std::default_sentinel_t)
+    {
+      return a.it_ == a.end_;
+    }
+
+   private:
+    std::ranges::iterator_t<V> it_{};
+    std::ranges::sentinel_t<V> end_{};
+    Encoder enc_;
+    value_type action_ = ENCODER_ACTION_NONE;
+  };
+
+  decode_view()
+    requires std::default_initializable<V>
+  = default;
+
+  explicit decode_view(V base)
+    : base_(std::move(base))
+  {
+  }
+
+  V base() const&
+    requires std::copy_constructible<V>
+  {
+    return base_;
+  }
+
+  iterator begin()
+  {
+    return iterator(std::ranges::begin(base_), std::ranges::end(base_));
+  }
+
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+  auto size()
+    requires std::ranges::sized_range<V>
+  {
+    return std::ranges::size(base_);
+  }
+
+ private:
+  V base_ = V();
+};
+
+template <std::ranges::view V, typename Encoder>
+  requires std::ranges::input_range<V>
+class steps_view : public std::ranges::view_interface<steps_view<V, Encoder>>
+{
+ public:
+  /* updates an encoder with each sample, stopping at each action */
+  class iterator
+  {
+   public:
+    using iterator_concept = detail::iterator_concept_t<V>;
+    using value_type = step;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    iterator(std::ranges::iterator_t<V> it, std::ranges::sentinel_t<V> end)
+      : it_(std::move(it))
+      , end_(std::move(end))
+    {
+      if (it_ != end_)
+      {
+        enc_.init(*it_);
+        find();
+      }
+    }
+
+    value_type const& operator*() const { return step_; }
+    value_type const* operator->() const { return &step_; }
+
+    iterator& operator++()
+    {
+      ++it_;
+      ++step_.index;
+      find();
+
+      return *this;
+    }
+
+    void operator++(int) { ++*this; }
+
+    iterator operator++(int)
+      requires std::ranges::forward_range<V>
+    {
+      iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(iterator const& a, iterator const& b)
+      requires std::ranges::forward_range<V>
+    {
+      return a.it_ == b.it_;
+    }
+
+    friend bool operator==(iterator const& a, std::default_sentinel_t)
+    {
+      return a.it_ == a.end_;
+    }
+
+   private:
+    void find()
+    {
+      for (; it_ != end_; ++it_, ++step_.index)
+      {
+        enum ::encoder_action const action = enc_.update(*it_);
+
+        if (action != ENCODER_ACTION_NONE)
+        {
+          step_.action = action;
+          step_.position += action == ENCODER_ACTION_TURN_CW ? 1 : -1;
+          break;
+        }
+      }
+    }
+
+    std::ranges::iterator_t<V> it_{};
+    std::ranges::sentinel_t<V> end_{};
+    Encoder enc_;
+    step step_{0, ENCODER_ACTION_NONE, 0};
+  };
+
+  /* skips chunks without actions as a whole */
+  class batch_iterator
+  {
+   public:
+    using iterator_concept = std::forward_iterator_tag;
+    using value_type = step;
+    using difference_type = std::ptrdiff_t;
+
+    batch_iterator() = default;
+
+    batch_iterator(void const* data, std::size_t size)
+      : cursor_(data, size)
+      , pending_(cursor_.actions())
+    {
+      find();
+    }
+
+    value_type const& operator*() const { return step_; }
+    value_type const* operator->() const { return &step_; }
+
+    batch_iterator& operator++()
+    {
+      find();
+      return *this;
+    }
+
+    batch_iterator operator++(int)
+    {
+      batch_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(batch_iterator const& a, batch_iterator const& b)
+    {
+      return a.step_.index == b.step_.index;
+    }
+
+    friend bool operator==(batch_iterator const& a, std::default_sentinel_t)
+    {
+      return a.step_.index >= a.cursor_.size();
+    }
+
+   private:
+    void find()
+    {
+      while (pending_ == 0)
+      {
+        if (!cursor_.next())
+        {
+          step_.index = cursor_.size();
+          return;
+        }
+
+        pending_ = cursor_.actions();
+      }
+
+      int const bit = std::countr_zero(pending_) & ~1;
+
+      step_.index = cursor_.chunk() + static_cast<std::size_t>(bit / 2);
+      step_.action = static_cast<enum ::encoder_action>(pending_ >> bit & 0x3);
+      step_.position += step_.action == ENCODER_ACTION_TURN_CW ? 1 : -1;
+      pending_ &= ~(UINT64_C(0x3) << bit);
+    }
+
+    detail::batch_cursor<Encoder> cursor_;
+    std::uint64_t pending_ = 0;
+    step step_{0, ENCODER_ACTION_NONE, 0};
+  };
+
+  steps_view()
+    requires std::default_initializable<V>
+  = default;
+
+  explicit steps_view(V base)
+    : base_(std::move(base))
+  {
+  }
+
+  V base() const&
+    requires std::copy_constructible<V>
+  {
+    return base_;
+  }
+
+  auto begin()
+  {
+    if constexpr (detail::batch_decodable<V, Encoder>)
+    {
+      return batch_iterator(std::ranges::data(base_),
+                            std::ranges::size(base_));
+    }
+    else
+    {
+      return iterator(std::ranges::begin(base_), std::ranges::end(base_));
+    }
+  }
+
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+ private:
+  V base_ = V();
+};
+
+namespace views
+{
+
+namespace detail
+{
+
+template <template <typename, typename> class View, typename Encoder>
+struct adaptor
+{
+  template <std::ranges::viewable_range R>
+  auto operator()(R&& r) const
+  {
+    return View<std::views::all_t<R>, Encoder>(
+        std::views::all(std::forward<R>(r)));
+  }
+
+  template <std::ranges::viewable_range R>
+  friend auto operator|(R&& r, adaptor const& a)
+  {
+    return a(std::forward<R>(r));
+  }
+};
+
+}
+
+/*
+ * Yields the action of each sample.
+ */
+template <typename Encoder>
+constexpr detail::adaptor<decode_view, Encoder> decode() noexcept
+{
+  return {};
+}
+
+/*
+ * Yields only the samples that cause an action, along with their index
+ * and the position after the action.
+ */
+template <typename Encoder>
+constexpr detail::adaptor<steps_view, Encoder> steps() noexcept
+{
+  return {};
+}
+
+}
+
+}
+
+#endif
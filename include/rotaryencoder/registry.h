@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_REGISTRY_H
+#define INCLUDE_ROTARYENCODER_REGISTRY_H
+
+#include <rotaryencoder/batch.h>
+
+/*
+ * A registry of encoders decoded by several threads.
+ *
+ * The encoders are split into shards of consecutive encoders, one per
+ * decoding thread. The states and positions of each shard live in their
+ * own cache-line-aligned block of memory, so threads never write to the
+ * same cache line. Within a shard, encoders are addressed by their index
+ * relative to the first encoder of the shard. Only the owning thread may
+ * update the encoders of a shard, while positions can be read from any
+ * thread at any time.
+ *
+ * With ENCODER_REGISTRY_FIRST_TOUCH, the memory of a shard is allocated
+ * and initialised by the first call to encoder_registry_get_shard(), which
+ * should be made by the owning thread. On NUMA systems with the default
+ * first-touch policy, this places the memory on the node of that thread.
+ * Otherwise, all shards are allocated by encoder_registry_create().
+ *
+ * The states of all encoders are zero-initialised and must be initialised
+ * using the init function of the respective flavour, e.g.:
+ *
+ *   encoder_debounced_full_step_init(
+ *       encoder_registry_state(shard, i), terminal);
+ */
+
+#define ENCODER_REGISTRY_FIRST_TOUCH 0x1
+
+typedef struct encoder_registry encoder_registry;
+
+/*
+ * The positions are only written by the owning thread, so a plain load and
+ * store are enough to update them. Atomic builtins are used so the values
+ * can be read safely from other threads, which costs nothing extra on
+ * common hosts.
+ */
+typedef struct encoder_registry_shard
+{
+  size_t first;
+  size_t count;
+  encoder_state* states;
+  encoder_position_t* positions;
+} encoder_registry_shard;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Create a registry for `encoders` encoders in `shards` shards. Returns
+   * NULL if the memory can't be allocated.
+   */
+  encoder_registry* encoder_registry_create(size_t encoders, size_t shards,
+                                            unsigned flags);
+
+  void encoder_registry_destroy(encoder_registry* r);
+
+  /*
+   * Returns shard `s`, or NULL if its memory can't be allocated.
+   */
+  encoder_registry_shard* encoder_registry_get_shard(encoder_registry* r,
+                                                     size_t s);
+
+  /*
+   * Returns the global index of the first encoder in the shard.
+   */
+  static ENCODER_INLINE size_t
+  encoder_registry_shard_first(encoder_registry_shard const* shard)
+  {
+    return shard->first;
+  }
+
+  static ENCODER_INLINE size_t
+  encoder_registry_shard_size(encoder_registry_shard const* shard)
+  {
+    return shard->count;
+  }
+
+  static ENCODER_INLINE encoder_state*
+  encoder_registry_state(encoder_registry_shard* shard, size_t i)
+  {
+    return &shard->states[i];
+  }
+
+  static ENCODER_INLINE void
+  encoder_internal_registry_add(encoder_position_t* position,
+                                encoder_position_t delta)
+  {
+    __atomic_store_n(position,
+                     __atomic_load_n(position, __ATOMIC_RELAXED) + delta,
+                     __ATOMIC_RELAXED);
+  }
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_registry_update_tt(encoder_registry_shard* shard, size_t i,
+                             encoder_fast_byte_t terminal,
+                             encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+  {
+    enum encoder_action const action =
+        encoder_internal_update_tt(&shard->states[i], terminal, table);
+
+    if (action != ENCODER_ACTION_NONE)
+    {
+      encoder_internal_registry_add(
+          &shard->positions[i], action == ENCODER_ACTION_TURN_CW ? 1 : -1);
+    }
+
+    return action;
+  }
+
+  /*
+   * Decode packed samples of encoder `i` as encoder_batch_update_tt()
+   * does, and add the result to its position.
+   */
+  encoder_position_t encoder_registry_update_batch_tt(
+      encoder_registry_shard* shard, size_t i, uint64_t const* samples,
+      uint64_t* actions, size_t words,
+      encoder_byte_t ENCODER_CONST_MEMORY table[][4]);
+
+  /*
+   * Returns the position of the encoder with the global index `encoder`.
+   */
+  encoder_position_t encoder_registry_position(encoder_registry const* r,
+                                               size_t encoder);
+
+  /*
+   * Read the positions of all encoders, and return their sum.
+   */
+  encoder_position_t encoder_registry_read(encoder_registry const* r,
+                                           encoder_position_t* positions);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
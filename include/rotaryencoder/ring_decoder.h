@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_RING_DECODER_H
+#define INCLUDE_ROTARYENCODER_RING_DECODER_H
+
+#include <stddef.h>
+
+#include <rotaryencoder/common.h>
+
+/*
+ * Decoding of encoder samples captured into a circular buffer, e.g. by a
+ * timer-triggered DMA transfer of a GPIO input register.
+ *
+ * Each sample word holds the terminals of several encoders at arbitrary bit
+ * positions. The decoder keeps track of the state and position of each
+ * encoder, and of the position in the ring up to which samples have been
+ * decoded. It is handed the end of each region that has been filled, e.g.
+ * from the half-transfer and transfer-complete interrupts:
+ *
+ *   half-transfer:     encoder_ring_decode(&ring, size / 2);
+ *   transfer-complete: encoder_ring_decode(&ring, 0);
+ *
+ * The end may also be derived from the remaining transfer count of the DMA
+ * channel at any time. Regions wrapping around the end of the ring are
+ * handled transparently. As the decoder can't tell an empty region from a
+ * full one, it must be called before the whole ring has been overwritten.
+ *
+ * All encoders use the same transition table. The state of each encoder must
+ * be initialised using the init function of the respective flavour, e.g.:
+ *
+ *   encoder_debounced_half_step_init(
+ *       &enc[i].state, encoder_ring_terminal(&enc[i], buffer[0]));
+ */
+
+#ifndef ENCODER_RING_SAMPLE_TYPE
+#define ENCODER_RING_SAMPLE_TYPE unsigned short
+#endif
+
+typedef ENCODER_RING_SAMPLE_TYPE encoder_ring_sample_t;
+
+typedef struct encoder_ring_encoder
+{
+  encoder_position_t position;
+  encoder_byte_t pin_a;
+  encoder_byte_t pin_b;
+  encoder_state state;
+} encoder_ring_encoder;
+
+typedef struct encoder_ring
+{
+  encoder_ring_sample_t const* buffer;
+  size_t size;
+  size_t next;
+  encoder_ring_encoder* encoders;
+  encoder_byte_t ENCODER_CONST_MEMORY (*table)[4];
+  encoder_byte_t count;
+} encoder_ring;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Set up encoder `e` with its A and B terminals at bit positions `pin_a`
+   * and `pin_b` of the sample word. The state must be initialised
+   * separately, see above.
+   */
+  static ENCODER_INLINE void encoder_ring_encoder_init(encoder_ring_encoder* e,
+                                                       encoder_byte_t pin_a,
+                                                       encoder_byte_t pin_b)
+  {
+    e->position = 0;
+    e->pin_a = pin_a;
+    e->pin_b = pin_b;
+    e->state = 0;
+  }
+
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_ring_terminal(encoder_ring_encoder const* e,
+                        encoder_ring_sample_t sample)
+  {
+    return (encoder_fast_byte_t)(((sample >> e->pin_a) & 1) |
+                                 ((sample >> e->pin_b) & 1) << 1);
+  }
+
+  /*
+   * Set up ring `r` to decode the `count` encoders in `encoders` from the
+   * circular buffer of `size` samples at `buffer`, using transition table
+   * `table`. Decoding starts at the first sample of the buffer.
+   */
+  static ENCODER_INLINE void
+  encoder_ring_init(encoder_ring* r, encoder_ring_sample_t const* buffer,
+                    size_t size, encoder_ring_encoder* encoders,
+                    encoder_byte_t count,
+                    encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+  {
+    r->buffer = buffer;
+    r->size = size;
+    r->next = 0;
+    r->encoders = encoders;
+    r->table = table;
+    r->count = count;
+  }
+
+  /*
+   * Decode all samples from where the previous call stopped up to (but not
+   * including) sample `end`, wrapping around the end of the ring if needed.
+   * An `end` equal to the ring size is the same as 0. Returns the number of
+   * actions generated by all encoders.
+   */
+  unsigned encoder_ring_decode(encoder_ring* r, size_t end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
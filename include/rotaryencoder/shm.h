@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROTARYENCODER_SHM_H
+#define INCLUDE_ROTARYENCODER_SHM_H
+
+#include <stddef.h>
+
+#include <rotaryencoder/common.h>
+
+#if !defined(UINT64_MAX)
+#error "rotaryencoder/shm.h requires a C99 or C++11 compiler"
+#endif
+
+/*
+ * Publication of encoder positions to other processes via POSIX shared
+ * memory.
+ *
+ * A single writer, typically the process decoding the encoders, creates a
+ * named table and publishes the positions, e.g. after each batch. Any
+ * number of readers open the table by name and read positions without
+ * system calls or locks. The positions are stored in cache lines of
+ * ENCODER_SHM_LINE_POSITIONS each, and each cache line is protected by a
+ * sequence lock, so positions within a cache line are always read
+ * consistently. Readers never block the writer; they retry if the
+ * writer updates a cache line while it is being read.
+ *
+ * Functions returning pointers return NULL on failure, and functions
+ * returning int return 0 on success or -1 on failure, with errno set.
+ */
+
+#define ENCODER_SHM_LINE_POSITIONS 7
+
+typedef struct encoder_shm encoder_shm;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Create (or replace) the table `name` for `count` encoders, with all
+   * positions set to zero, and open it for writing. `name` follows the
+   * rules of shm_open(), i.e. it should start with a slash.
+   */
+  encoder_shm* encoder_shm_create(char const* name, size_t count);
+
+  /*
+   * Open an existing table for reading.
+   */
+  encoder_shm* encoder_shm_open(char const* name);
+
+  /*
+   * Unmap the table. This doesn't remove the name.
+   */
+  void encoder_shm_close(encoder_shm* shm);
+
+  int encoder_shm_unlink(char const* name);
+
+  size_t encoder_shm_count(encoder_shm const* shm);
+
+  /*
+   * Publish the `n` positions of the encoders starting at `first`.
+   */
+  void encoder_shm_publish(encoder_shm* shm, size_t first,
+                           encoder_position_t const* positions, size_t n);
+
+  /*
+   * Read the `n` positions of the encoders starting at `first`. Returns
+   * the number of retries due to concurrent updates.
+   */
+  size_t encoder_shm_read(encoder_shm const* shm, size_t first,
+                          encoder_position_t* positions, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
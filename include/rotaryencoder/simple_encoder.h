@@ -25,6 +25,33 @@
 
 #include <rotaryencoder/common.h>
 
+/*
+ * The simple strategies always move to the state given by the terminals,
+ * so their transition tables reduce to 16 2-bit actions that fit into a
+ * single 32-bit constant. The `_imm` variants look up the action using a
+ * shift and a mask on this constant, without any memory access.
+ */
+
+#define ENCODER_SIMPLE_FULL_STEP_IMM                                           \
+  (ENCODER_INTERNAL_IMM(1, 3, ENCODER_ACTION_TURN_CW) |                        \
+   ENCODER_INTERNAL_IMM(3, 1, ENCODER_ACTION_TURN_CCW))
+
+#define ENCODER_SIMPLE_HALF_STEP_IMM                                           \
+  (ENCODER_INTERNAL_IMM(0, 2, ENCODER_ACTION_TURN_CCW) |                       \
+   ENCODER_INTERNAL_IMM(1, 3, ENCODER_ACTION_TURN_CW) |                        \
+   ENCODER_INTERNAL_IMM(2, 0, ENCODER_ACTION_TURN_CW) |                        \
+   ENCODER_INTERNAL_IMM(3, 1, ENCODER_ACTION_TURN_CCW))
+
+#define ENCODER_SIMPLE_QUARTER_STEP_IMM                                        \
+  (ENCODER_INTERNAL_IMM(0, 1, ENCODER_ACTION_TURN_CW) |                        \
+   ENCODER_INTERNAL_IMM(0, 2, ENCODER_ACTION_TURN_CCW) |                       \
+   ENCODER_INTERNAL_IMM(1, 0, ENCODER_ACTION_TURN_CCW) |                       \
+   ENCODER_INTERNAL_IMM(1, 3, ENCODER_ACTION_TURN_CW) |                        \
+   ENCODER_INTERNAL_IMM(2, 0, ENCODER_ACTION_TURN_CW) |                        \
+   ENCODER_INTERNAL_IMM(2, 3, ENCODER_ACTION_TURN_CCW) |                       \
+   ENCODER_INTERNAL_IMM(3, 1, ENCODER_ACTION_TURN_CCW) |                       \
+   ENCODER_INTERNAL_IMM(3, 2, ENCODER_ACTION_TURN_CW))
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -32,8 +59,16 @@ extern "C"
 
   extern ENCODER_CONST_MEMORY encoder_byte_t
       encoder_simple_full_step_table[4][4];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_simple_full_step_edges_table[4];
   extern ENCODER_CONST_MEMORY encoder_byte_t
       encoder_simple_half_step_table[4][4];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_simple_half_step_edges_table[4];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_simple_quarter_step_table[4][4];
+  extern ENCODER_CONST_MEMORY encoder_byte_t
+      encoder_simple_quarter_step_edges_table[4];
 
   static ENCODER_INLINE void
   encoder_simple_full_step_init(encoder_state* s, encoder_fast_byte_t terminal)
@@ -47,6 +82,13 @@ extern "C"
     *s = terminal;
   }
 
+  static ENCODER_INLINE void
+  encoder_simple_quarter_step_init(encoder_state* s,
+                                   encoder_fast_byte_t terminal)
+  {
+    *s = terminal;
+  }
+
   enum encoder_action
   encoder_simple_full_step_update(encoder_state* s,
                                   encoder_fast_byte_t terminal);
@@ -59,6 +101,22 @@ extern "C"
                                       encoder_simple_full_step_table);
   }
 
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_simple_full_step_edges_tt(encoder_state const* s,
+                                    encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_edges_tt(s, terminal,
+                                     encoder_simple_full_step_edges_table);
+  }
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_simple_full_step_update_imm(encoder_state* s,
+                                      encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_update_imm(s, terminal,
+                                       ENCODER_SIMPLE_FULL_STEP_IMM);
+  }
+
   enum encoder_action
   encoder_simple_half_step_update(encoder_state* s,
                                   encoder_fast_byte_t terminal);
@@ -71,6 +129,50 @@ extern "C"
                                       encoder_simple_half_step_table);
   }
 
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_simple_half_step_edges_tt(encoder_state const* s,
+                                    encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_edges_tt(s, terminal,
+                                     encoder_simple_half_step_edges_table);
+  }
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_simple_half_step_update_imm(encoder_state* s,
+                                      encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_update_imm(s, terminal,
+                                       ENCODER_SIMPLE_HALF_STEP_IMM);
+  }
+
+  enum encoder_action
+  encoder_simple_quarter_step_update(encoder_state* s,
+                                     encoder_fast_byte_t terminal);
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_simple_quarter_step_update_tt(encoder_state* s,
+                                        encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_update_tt(s, terminal,
+                                      encoder_simple_quarter_step_table);
+  }
+
+  static ENCODER_INLINE encoder_fast_byte_t
+  encoder_simple_quarter_step_edges_tt(encoder_state const* s,
+                                       encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_edges_tt(s, terminal,
+                                     encoder_simple_quarter_step_edges_table);
+  }
+
+  static ENCODER_INLINE enum encoder_action
+  encoder_simple_quarter_step_update_imm(encoder_state* s,
+                                         encoder_fast_byte_t terminal)
+  {
+    return encoder_internal_update_imm(s, terminal,
+                                       ENCODER_SIMPLE_QUARTER_STEP_IMM);
+  }
+
 #ifdef __cplusplus
 }
 #endif
@@ -128,6 +230,39 @@ class simple_encoder_full_step_tt
     return ::encoder_simple_full_step_update_tt(&s_, terminal);
   }
 
+  ::encoder_fast_byte_t edges(::encoder_fast_byte_t terminal) const
+  {
+    return ::encoder_simple_full_step_edges_tt(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class simple_encoder_full_step_imm
+{
+ public:
+#if __cplusplus >= 201103L
+  simple_encoder_full_step_imm() = default;
+#else
+  simple_encoder_full_step_imm() {}
+#endif
+
+  simple_encoder_full_step_imm(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_simple_full_step_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_simple_full_step_update_imm(&s_, terminal);
+  }
+
  private:
   encoder_state s_;
 };
@@ -181,6 +316,128 @@ class simple_encoder_half_step_tt
     return ::encoder_simple_half_step_update_tt(&s_, terminal);
   }
 
+  ::encoder_fast_byte_t edges(::encoder_fast_byte_t terminal) const
+  {
+    return ::encoder_simple_half_step_edges_tt(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class simple_encoder_half_step_imm
+{
+ public:
+#if __cplusplus >= 201103L
+  simple_encoder_half_step_imm() = default;
+#else
+  simple_encoder_half_step_imm() {}
+#endif
+
+  simple_encoder_half_step_imm(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_simple_half_step_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_simple_half_step_update_imm(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class simple_encoder_quarter_step
+{
+ public:
+#if __cplusplus >= 201103L
+  simple_encoder_quarter_step() = default;
+#else
+  simple_encoder_quarter_step() {}
+#endif
+
+  simple_encoder_quarter_step(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_simple_quarter_step_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_simple_quarter_step_update(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class simple_encoder_quarter_step_tt
+{
+ public:
+#if __cplusplus >= 201103L
+  simple_encoder_quarter_step_tt() = default;
+#else
+  simple_encoder_quarter_step_tt() {}
+#endif
+
+  simple_encoder_quarter_step_tt(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_simple_quarter_step_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_simple_quarter_step_update_tt(&s_, terminal);
+  }
+
+  ::encoder_fast_byte_t edges(::encoder_fast_byte_t terminal) const
+  {
+    return ::encoder_simple_quarter_step_edges_tt(&s_, terminal);
+  }
+
+ private:
+  encoder_state s_;
+};
+
+class simple_encoder_quarter_step_imm
+{
+ public:
+#if __cplusplus >= 201103L
+  simple_encoder_quarter_step_imm() = default;
+#else
+  simple_encoder_quarter_step_imm() {}
+#endif
+
+  simple_encoder_quarter_step_imm(::encoder_fast_byte_t terminal)
+  {
+    init(terminal);
+  }
+
+  void init(::encoder_fast_byte_t terminal)
+  {
+    ::encoder_simple_quarter_step_init(&s_, terminal);
+  }
+
+  enum ::encoder_action update(::encoder_fast_byte_t terminal)
+  {
+    return ::encoder_simple_quarter_step_update_imm(&s_, terminal);
+  }
+
  private:
   encoder_state s_;
 };
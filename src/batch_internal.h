@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SRC_BATCH_INTERNAL_H
+#define SRC_BATCH_INTERNAL_H
+
+#include <rotaryencoder/batch.h>
+
+#define ENCODER_INTERNAL_BATCH_EVEN_BITS UINT64_C(0x5555555555555555)
+#define ENCODER_INTERNAL_BATCH_ODD_BITS UINT64_C(0xAAAAAAAAAAAAAAAA)
+
+/*
+ * Resolve the hysteresis of the channel selected by `channel` for all 32
+ * samples at once. Each set event must be followed by ones up to the next
+ * reset event. Adding `set` to a mask that has ones at all positions
+ * that don't reset makes a carry ripple from each set event up to the next
+ * reset event, which is exactly where the output needs to be high. The
+ * bits of the other channel just let the carry pass, and `carry` is the
+ * initial level of the channel at its first bit.
+ */
+static inline uint64_t encoder_internal_batch_fill(uint64_t set,
+                                                   uint64_t reset,
+                                                   uint64_t channel,
+                                                   uint64_t carry)
+{
+  uint64_t const hold = ~(set | reset) & channel;
+  uint64_t const pass = hold | set | ~channel;
+  uint64_t const carries = (pass + set + carry) ^ pass ^ set;
+
+  return set | (carries & hold);
+}
+
+typedef encoder_position_t (*encoder_internal_batch_kernel)(
+    encoder_state* s, uint64_t const* samples, uint64_t* actions,
+    size_t words, encoder_byte_t ENCODER_CONST_MEMORY table[][4]);
+
+encoder_position_t encoder_internal_batch_update_tt_generic(
+    encoder_state* s, uint64_t const* samples, uint64_t* actions,
+    size_t words, encoder_byte_t ENCODER_CONST_MEMORY table[][4]);
+
+#ifdef ROTARYENCODER_HAVE_BMI2
+encoder_position_t encoder_internal_batch_update_tt_bmi2(
+    encoder_state* s, uint64_t const* samples, uint64_t* actions,
+    size_t words, encoder_byte_t ENCODER_CONST_MEMORY table[][4]);
+#endif
+
+#endif
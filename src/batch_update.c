@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch_internal.h"
+#include "encoder_trace.h"
+
+#ifdef ROTARYENCODER_HAVE_USDT
+#define ENCODER_INTERNAL_TRACE_SEMAPHORE(name)                                 \
+  unsigned short rotaryencoder_##name##_semaphore                              \
+      __attribute__((section(".probes")))
+
+ENCODER_INTERNAL_TRACE_SEMAPHORE(batch_entry);
+ENCODER_INTERNAL_TRACE_SEMAPHORE(batch_exit);
+ENCODER_INTERNAL_TRACE_SEMAPHORE(illegal);
+ENCODER_INTERNAL_TRACE_SEMAPHORE(actions);
+#endif
+
+struct encoder_internal_batch_impl
+{
+  enum encoder_batch_isa isa;
+  char const* name;
+  int (*supported)(void);
+  encoder_internal_batch_kernel kernel;
+};
+
+encoder_position_t encoder_internal_batch_update_tt_generic(
+    encoder_state* s, uint64_t const* samples, uint64_t* actions,
+    size_t words, encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+{
+  encoder_fast_byte_t state = *s;
+  encoder_position_t delta = 0;
+
+  for (size_t i = 0; i < words; ++i)
+  {
+    uint64_t const w = samples[i];
+    uint64_t out = 0;
+
+    for (unsigned k = 0; k < 64; k += 2)
+    {
+      encoder_fast_byte_t const e = table[state][(w >> k) & 0x3];
+      encoder_fast_byte_t const action = e >> ENCODER_INTERNAL_ACTION_SHIFT_TT;
+      state = e & ENCODER_INTERNAL_STATE_MASK_TT;
+      out |= (uint64_t)action << k;
+      delta += (encoder_position_t)(action & 1) - (action >> 1);
+    }
+
+    if (actions)
+    {
+      actions[i] = out;
+    }
+
+    if (ENCODER_TRACE_ENABLED(actions) && out)
+    {
+      ENCODER_TRACE3(actions, samples, i, out);
+    }
+  }
+
+  *s = state;
+
+  return delta;
+}
+
+static int encoder_internal_batch_supported_generic(void) { return 1; }
+
+#ifdef ROTARYENCODER_HAVE_BMI2
+static int encoder_internal_batch_supported_bmi2(void)
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("bmi2");
+}
+#endif
+
+/* in order of preference */
+static struct encoder_internal_batch_impl const encoder_internal_batch_impls[] =
+    {
+#ifdef ROTARYENCODER_HAVE_BMI2
+        {ENCODER_BATCH_ISA_BMI2, "bmi2", encoder_internal_batch_supported_bmi2,
+         encoder_internal_batch_update_tt_bmi2},
+#endif
+        {ENCODER_BATCH_ISA_GENERIC, "generic",
+         encoder_internal_batch_supported_generic,
+         encoder_internal_batch_update_tt_generic},
+};
+
+#define ENCODER_INTERNAL_BATCH_NUM_IMPLS                                       \
+  (sizeof(encoder_internal_batch_impls) /                                      \
+   sizeof(encoder_internal_batch_impls[0]))
+
+static struct encoder_internal_batch_impl const* _Atomic
+    encoder_internal_batch_current;
+
+static struct encoder_internal_batch_impl const*
+encoder_internal_batch_find(enum encoder_batch_isa isa)
+{
+  for (size_t i = 0; i < ENCODER_INTERNAL_BATCH_NUM_IMPLS; ++i)
+  {
+    struct encoder_internal_batch_impl const* impl =
+        &encoder_internal_batch_impls[i];
+
+    if ((isa == ENCODER_BATCH_ISA_AUTO || isa == impl->isa) &&
+        impl->supported())
+    {
+      return impl;
+    }
+  }
+
+  return NULL;
+}
+
+static struct encoder_internal_batch_impl const*
+encoder_internal_batch_resolve(void)
+{
+  char const* name = getenv("ROTARYENCODER_BATCH_ISA");
+
+  if (name)
+  {
+    for (size_t i = 0; i < ENCODER_INTERNAL_BATCH_NUM_IMPLS; ++i)
+    {
+      struct encoder_internal_batch_impl const* impl =
+          &encoder_internal_batch_impls[i];
+
+      if (strcmp(name, impl->name) == 0 && impl->supported())
+      {
+        return impl;
+      }
+    }
+  }
+
+  return encoder_internal_batch_find(ENCODER_BATCH_ISA_AUTO);
+}
+
+static struct encoder_internal_batch_impl const*
+encoder_internal_batch_get(void)
+{
+  struct encoder_internal_batch_impl const* impl = atomic_load_explicit(
+      &encoder_internal_batch_current, memory_order_relaxed);
+
+  if (!impl)
+  {
+    impl = encoder_internal_batch_resolve();
+    atomic_store_explicit(&encoder_internal_batch_current, impl,
+                          memory_order_relaxed);
+  }
+
+  return impl;
+}
+
+#ifdef __GNUC__
+__attribute__((constructor)) static void encoder_internal_batch_init(void)
+{
+  (void)encoder_internal_batch_get();
+}
+#endif
+
+char const* encoder_batch_isa_name(enum encoder_batch_isa isa)
+{
+  switch (isa)
+  {
+  case ENCODER_BATCH_ISA_AUTO:
+    return "auto";
+  case ENCODER_BATCH_ISA_GENERIC:
+    return "generic";
+  case ENCODER_BATCH_ISA_BMI2:
+    return "bmi2";
+  }
+
+  return NULL;
+}
+
+int encoder_batch_isa_supported(enum encoder_batch_isa isa)
+{
+  return encoder_internal_batch_find(isa) != NULL;
+}
+
+int encoder_batch_select_isa(enum encoder_batch_isa isa)
+{
+  struct encoder_internal_batch_impl const* impl =
+      isa == ENCODER_BATCH_ISA_AUTO ? encoder_internal_batch_resolve()
+                                    : encoder_internal_batch_find(isa);
+
+  if (!impl)
+  {
+    return -1;
+  }
+
+  atomic_store_explicit(&encoder_internal_batch_current, impl,
+                        memory_order_relaxed);
+
+  return 0;
+}
+
+enum encoder_batch_isa encoder_batch_selected_isa(void)
+{
+  return encoder_internal_batch_get()->isa;
+}
+
+#ifdef ROTARYENCODER_HAVE_USDT
+/*
+ * Reports the samples in which both terminals changed at once. The first
+ * sample of the batch has no known predecessor and is never reported.
+ */
+static void encoder_internal_batch_trace_illegal(uint64_t const* samples,
+                                                 size_t words)
+{
+  uint64_t prev = words > 0 ? samples[0] & 0x3 : 0;
+
+  for (size_t i = 0; i < words; ++i)
+  {
+    uint64_t const w = samples[i];
+    uint64_t const d = w ^ (w << 2 | prev);
+    uint64_t const mask = d & d >> 1 & ENCODER_INTERNAL_BATCH_EVEN_BITS;
+
+    if (mask)
+    {
+      ENCODER_TRACE3(illegal, samples, i, mask);
+    }
+
+    prev = w >> 62;
+  }
+}
+#endif
+
+encoder_position_t
+encoder_batch_update_tt(encoder_state* s, uint64_t const* samples,
+                        uint64_t* actions, size_t words,
+                        encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+{
+  encoder_position_t delta;
+
+  ENCODER_TRACE4(batch_entry, *s, samples, words, table);
+
+#ifdef ROTARYENCODER_HAVE_USDT
+  if (ENCODER_TRACE_ENABLED(illegal))
+  {
+    encoder_internal_batch_trace_illegal(samples, words);
+  }
+#endif
+
+  delta = encoder_internal_batch_get()->kernel(s, samples, actions, words,
+                                               table);
+
+  ENCODER_TRACE2(batch_exit, *s, delta);
+
+  return delta;
+}
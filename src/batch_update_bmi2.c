@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <immintrin.h>
+
+#include "batch_internal.h"
+#include "encoder_trace.h"
+
+/*
+ * Splits the A and B terminals of 32 samples into separate bit streams
+ * using PEXT, which allows computing a mask of the samples that differ
+ * from their predecessor. Repeated samples don't cause a transition
+ * (unless the previous transition was an error transition, which resets
+ * the state independent of the terminal value), so only the changed
+ * samples need to be run through the transition table. The resulting
+ * actions are scattered back into the packed layout with PDEP.
+ */
+
+encoder_position_t encoder_internal_batch_update_tt_bmi2(
+    encoder_state* s, uint64_t const* samples, uint64_t* actions,
+    size_t words, encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+{
+  encoder_fast_byte_t state = *s;
+  encoder_position_t delta = 0;
+
+  for (size_t i = 0; i < words; ++i)
+  {
+    uint64_t const w = samples[i];
+    uint32_t const a = (uint32_t)_pext_u64(w, ENCODER_INTERNAL_BATCH_EVEN_BITS);
+    uint32_t const b = (uint32_t)_pext_u64(w, ENCODER_INTERNAL_BATCH_ODD_BITS);
+
+    /* the first sample is always processed, its predecessor is unknown */
+    uint32_t todo = (a ^ (a << 1)) | (b ^ (b << 1)) | 1;
+    uint32_t cw = 0;
+    uint32_t ccw = 0;
+
+    while (todo)
+    {
+      unsigned const k = (unsigned)__builtin_ctz(todo);
+      encoder_fast_byte_t const t = ((a >> k) & 1) | (((b >> k) & 1) << 1);
+      encoder_fast_byte_t const e = table[state][t];
+      encoder_fast_byte_t const action = e >> ENCODER_INTERNAL_ACTION_SHIFT_TT;
+
+      state = e & ENCODER_INTERNAL_STATE_MASK_TT;
+      cw |= (uint32_t)(action & 1) << k;
+      ccw |= (uint32_t)(action >> 1) << k;
+      todo &= todo - 1;
+
+      /* error transitions aren't idempotent, the next sample matters */
+      if (table[state][t] != state)
+      {
+        todo |= (uint32_t)2 << k;
+      }
+    }
+
+    if (actions)
+    {
+      actions[i] = _pdep_u64(cw, ENCODER_INTERNAL_BATCH_EVEN_BITS) |
+                   _pdep_u64(ccw, ENCODER_INTERNAL_BATCH_ODD_BITS);
+    }
+
+    if (ENCODER_TRACE_ENABLED(actions) && (cw | ccw))
+    {
+      ENCODER_TRACE3(actions, samples, i,
+                     _pdep_u64(cw, ENCODER_INTERNAL_BATCH_EVEN_BITS) |
+                         _pdep_u64(ccw, ENCODER_INTERNAL_BATCH_ODD_BITS));
+    }
+
+    delta += __builtin_popcount(cw) - __builtin_popcount(ccw);
+  }
+
+  *s = state;
+
+  return delta;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/debounced_encoder.h>
+
+#define EU_STATE_MASK 0x3
+#define EU_ZERO_STATE 0x3
+#define EU_CCW_FLAG 0x80
+#define EU_CCW_SHIFT 7
+#define EU_DIR_KNOWN 0x40
+#define EU_DIR_CCW 0x20
+#define EU_CW_FLIP(state) (1 + (((state) ^ ((state) >> 1)) & 1))
+
+static enum encoder_action
+encoder_debounced_full_step_recovering_step(encoder_state* s,
+                                            encoder_fast_byte_t terminal)
+{
+  encoder_fast_byte_t const state = *s & EU_STATE_MASK;
+  encoder_fast_byte_t const ccw = *s & EU_CCW_FLAG;
+
+  *s = terminal |
+       ((state ^ terminal) == EU_CW_FLIP(state) ? EU_DIR_KNOWN
+                                                : EU_DIR_KNOWN | EU_DIR_CCW) |
+       (state == EU_ZERO_STATE ? (terminal & 1) << EU_CCW_SHIFT : ccw);
+
+  if (terminal == EU_ZERO_STATE && state == (ccw ? 2 : 1))
+  {
+    return (enum encoder_action)(state);
+  }
+
+  return ENCODER_ACTION_NONE;
+}
+
+enum encoder_action
+encoder_debounced_full_step_recovering_update(encoder_state* s,
+                                              encoder_fast_byte_t terminal)
+{
+  encoder_fast_byte_t const state = *s & EU_STATE_MASK;
+  encoder_fast_byte_t const sxt = state ^ terminal;
+
+  if (sxt == 0)
+  {
+    return ENCODER_ACTION_NONE;
+  }
+
+  if (sxt == EU_STATE_MASK)
+  {
+    encoder_fast_byte_t flip;
+    enum encoder_action action;
+
+    if ((*s & EU_DIR_KNOWN) == 0)
+    {
+      /* invalid transition, direction unknown, reset to zero state (11) */
+      *s = EU_ZERO_STATE;
+      return ENCODER_ACTION_NONE;
+    }
+
+    /* missed transition, replay the skipped position in last direction */
+    flip = EU_CW_FLIP(state);
+
+    if (*s & EU_DIR_CCW)
+    {
+      flip ^= EU_STATE_MASK;
+    }
+
+    action = encoder_debounced_full_step_recovering_step(s, state ^ flip);
+
+    return (enum encoder_action)(
+        action | encoder_debounced_full_step_recovering_step(s, terminal));
+  }
+
+  return encoder_debounced_full_step_recovering_step(s, terminal);
+}
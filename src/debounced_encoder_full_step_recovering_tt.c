@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/fused.h>
+
+/*
+ * Same as encoder_debounced_full_step_table, but each state also tracks the
+ * direction of the last transition (C: clockwise, A: anti-clockwise, X: not
+ * known), which is used to recover (R) from a single missed transition.
+ */
+
+enum
+{
+  ES_NC000,
+  ES_NC001,
+  ES_NC010,
+  ES_SX011,
+  ES_NA000,
+  ES_NA010,
+  ES_SC011,
+  ES_SA011,
+  ES_PC100,
+  ES_PC101,
+  ES_PA100,
+  ES_PA101,
+  ES_PA110,
+
+  ESERROR = ES_SX011,
+  CW_NC010 =
+      ES_NC010 | (ENCODER_ACTION_TURN_CW << ENCODER_INTERNAL_ACTION_SHIFT_TT),
+  CW_SC011 =
+      ES_SC011 | (ENCODER_ACTION_TURN_CW << ENCODER_INTERNAL_ACTION_SHIFT_TT),
+  CC_SA011 =
+      ES_SA011 | (ENCODER_ACTION_TURN_CCW << ENCODER_INTERNAL_ACTION_SHIFT_TT),
+  CC_PA101 =
+      ES_PA101 | (ENCODER_ACTION_TURN_CCW << ENCODER_INTERNAL_ACTION_SHIFT_TT)
+};
+
+ENCODER_CONST_MEMORY encoder_byte_t
+    encoder_debounced_full_step_recovering_table[13][4] = {
+        /* clang-format off */
+        /*              00        01        10        11    */
+        /* ES_NC000 */ {ES_NC000, ES_NC001, ES_NA010, CW_SC011}, /*       R */
+        /* ES_NC001 */ {ES_NA000, ES_NC001, CW_NC010, CW_SC011}, /*     R   */
+        /* ES_NC010 */ {ES_NC000, ES_NC001, ES_NC010, ES_SA011}, /*   R     */
+        /* ES_SX011 */ {ESERROR,  ES_PA101, ES_NC010, ES_SX011}, /* E       */
+        /* ES_NA000 */ {ES_NA000, ES_NC001, ES_NA010, ES_SA011}, /*       R */
+        /* ES_NA010 */ {ES_NC000, ES_PA101, ES_NA010, ES_SA011}, /*   R     */
+        /* ES_SC011 */ {ES_NC000, ES_PA101, ES_NC010, ES_SC011}, /* R       */
+        /* ES_SA011 */ {ES_PA100, ES_PA101, ES_NC010, ES_SA011}, /* R       */
+        /* ES_PC100 */ {ES_PC100, ES_PC101, ES_PA110, ES_SC011}, /*       R */
+        /* ES_PC101 */ {ES_PA100, ES_PC101, ES_NC010, ES_SC011}, /*     R   */
+        /* ES_PA100 */ {ES_PA100, ES_PC101, ES_PA110, CC_SA011}, /*       R */
+        /* ES_PA101 */ {ES_PA100, ES_PA101, ES_PA110, ES_SC011}, /*     R   */
+        /* ES_PA110 */ {ES_PC100, CC_PA101, ES_PA110, CC_SA011}  /*   R     */
+        /* clang-format on */
+};
+
+ENCODER_CONST_MEMORY encoder_byte_t
+    encoder_debounced_full_step_recovering_edges_table[13] = {
+        /* clang-format off */
+        /* ES_NC000 */ ENCODER_TERMINAL_B,
+        /* ES_NC001 */ ENCODER_TERMINAL_B,
+        /* ES_NC010 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_SX011 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_NA000 */ ENCODER_TERMINAL_B,
+        /* ES_NA010 */ ENCODER_TERMINAL_B,
+        /* ES_SC011 */ ENCODER_TERMINAL_B,
+        /* ES_SA011 */ ENCODER_TERMINAL_A,
+        /* ES_PC100 */ ENCODER_TERMINAL_B,
+        /* ES_PC101 */ ENCODER_TERMINAL_A,
+        /* ES_PA100 */ ENCODER_TERMINAL_A,
+        /* ES_PA101 */ ENCODER_TERMINAL_B,
+        /* ES_PA110 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B
+        /* clang-format on */
+};
+
+ENCODER_CONST_MEMORY encoder_fused_t
+    encoder_debounced_full_step_recovering_fused_table[13][4] = {
+        /* clang-format off */
+        ENCODER_INTERNAL_FUSED_ROW(ES_NC000,
+                                   ES_NC000, ES_NC001, ES_NA010, CW_SC011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_NC001,
+                                   ES_NA000, ES_NC001, CW_NC010, CW_SC011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_NC010,
+                                   ES_NC000, ES_NC001, ES_NC010, ES_SA011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_SX011,
+                                   ESERROR, ES_PA101, ES_NC010, ES_SX011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_NA000,
+                                   ES_NA000, ES_NC001, ES_NA010, ES_SA011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_NA010,
+                                   ES_NC000, ES_PA101, ES_NA010, ES_SA011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_SC011,
+                                   ES_NC000, ES_PA101, ES_NC010, ES_SC011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_SA011,
+                                   ES_PA100, ES_PA101, ES_NC010, ES_SA011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_PC100,
+                                   ES_PC100, ES_PC101, ES_PA110, ES_SC011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_PC101,
+                                   ES_PA100, ES_PC101, ES_NC010, ES_SC011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_PA100,
+                                   ES_PA100, ES_PC101, ES_PA110, CC_SA011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_PA101,
+                                   ES_PA100, ES_PA101, ES_PA110, ES_SC011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_PA110,
+                                   ES_PC100, CC_PA101, ES_PA110, CC_SA011)
+        /* clang-format on */
+};
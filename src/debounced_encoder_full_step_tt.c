@@ -21,6 +21,7 @@
  */
 
 #include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/fused.h>
 
 enum
 {
@@ -54,3 +55,29 @@ ENCODER_CONST_MEMORY encoder_byte_t encoder_debounced_full_step_table[7][4] = {
     /* ES_P111    {ESERROR, ES_P101, ES_N010, ES_P111}  */ /* E       // N P N P */
     /* clang-format on */
 };
+
+ENCODER_CONST_MEMORY encoder_byte_t
+    encoder_debounced_full_step_edges_table[7] = {
+        /* clang-format off */
+        /* ES_N000 */ ENCODER_TERMINAL_A,
+        /* ES_N001 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_N010 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_S011 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_P100 */ ENCODER_TERMINAL_B,
+        /* ES_P101 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_P110 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B
+        /* clang-format on */
+};
+
+ENCODER_CONST_MEMORY encoder_fused_t
+    encoder_debounced_full_step_fused_table[7][4] = {
+        /* clang-format off */
+        ENCODER_INTERNAL_FUSED_ROW(ES_N000, ES_N000, ES_N001, ES_N010, ESERROR),
+        ENCODER_INTERNAL_FUSED_ROW(ES_N001, ES_N000, ES_N001, ESERROR, CW_S011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_N010, ES_N000, ESERROR, ES_N010, ES_S011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_S011, ESERROR, ES_P101, ES_N010, ES_S011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_P100, ES_P100, ES_P101, ES_P110, ESERROR),
+        ENCODER_INTERNAL_FUSED_ROW(ES_P101, ES_P100, ES_P101, ESERROR, ES_P111),
+        ENCODER_INTERNAL_FUSED_ROW(ES_P110, ES_P100, ESERROR, ES_P110, CC_P111)
+        /* clang-format on */
+};
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/debounced_encoder.h>
+
+/*
+ * Same logic as encoder_debounced_half_step_update(), but computed using
+ * only arithmetic and bitwise operations, so the instruction count doesn't
+ * depend on the input.
+ */
+
+enum encoder_action
+encoder_debounced_half_step_update_branchless(encoder_state* s,
+                                              encoder_fast_byte_t terminal)
+{
+#define EU_STATE_MASK 0x3
+#define EU_ZERO_STATE_HIGH 0x3
+#define EU_CCW_SHIFT 2
+#define EU_IS_ZERO(x) ((((x) + 3) >> 2) ^ 1)
+#define EU_MASK(x) ((encoder_fast_byte_t)-(x))
+
+  encoder_fast_byte_t const state = *s & EU_STATE_MASK;
+  encoder_fast_byte_t const ccw = *s >> EU_CCW_SHIFT;
+  encoder_fast_byte_t const sxt = state ^ terminal;
+  encoder_fast_byte_t const valid = EU_IS_ZERO(sxt ^ 0x3) ^ 1;
+  encoder_fast_byte_t const mid = (state ^ (state >> 1)) & 1;
+  encoder_fast_byte_t const dir =
+      (sxt >> 1) ^ ((ccw ^ (sxt >> 1)) & EU_MASK(mid));
+  encoder_fast_byte_t const hit = EU_IS_ZERO(sxt ^ (2 - ccw)) & mid & valid;
+
+  /* on invalid transitions, reset to the zero state matching the terminal */
+  *s = (encoder_state)(((terminal | dir << EU_CCW_SHIFT) & EU_MASK(valid)) |
+                       (EU_ZERO_STATE_HIGH &
+                        EU_MASK((EU_IS_ZERO(terminal) | valid) ^ 1)));
+
+  return (enum encoder_action)((1 + ccw) & EU_MASK(hit));
+}
@@ -21,6 +21,7 @@
  */
 
 #include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/fused.h>
 
 enum
 {
@@ -61,3 +62,27 @@ ENCODER_CONST_MEMORY encoder_byte_t encoder_debounced_half_step_table[6][4] = {
     /* ES_S111    {ESERR00, ES_P101, ES_N010, ES_S111}  */ /* E       // N P N P */
     /* clang-format on */
 };
+
+ENCODER_CONST_MEMORY encoder_byte_t
+    encoder_debounced_half_step_edges_table[6] = {
+        /* clang-format off */
+        /* ES_S000 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_N001 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_N010 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_S011 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_P101 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B,
+        /* ES_P110 */ ENCODER_TERMINAL_A | ENCODER_TERMINAL_B
+        /* clang-format on */
+};
+
+ENCODER_CONST_MEMORY encoder_fused_t
+    encoder_debounced_half_step_fused_table[6][4] = {
+        /* clang-format off */
+        ENCODER_INTERNAL_FUSED_ROW(ES_S000, ES_S100, ES_N001, ES_P110, ESERR11),
+        ENCODER_INTERNAL_FUSED_ROW(ES_N001, ES_S000, ES_N001, ESERRxx, CW_S011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_N010, CW_S000, ESERRxx, ES_N010, ES_S011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_S011, ESERR00, ES_P101, ES_N010, ES_S011),
+        ENCODER_INTERNAL_FUSED_ROW(ES_P101, CC_S100, ES_P101, ESERRxx, ES_S111),
+        ENCODER_INTERNAL_FUSED_ROW(ES_P110, ES_S100, ESERRxx, ES_P110, CC_S111)
+        /* clang-format on */
+};
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/acceleration.h>
+
+/*
+ * Update the average interval for a step in the direction of `action` at
+ * time `now`. Returns the average interval, limited to the last entry of
+ * the curve.
+ */
+static unsigned encoder_internal_accel_interval(encoder_accel* a,
+                                                encoder_accel_curve const* c,
+                                                enum encoder_action action,
+                                                unsigned now)
+{
+  unsigned const max = (unsigned)(c->size - 1) << c->shift;
+  unsigned interval = now - a->last;
+
+  if (interval > max)
+  {
+    interval = max;
+  }
+
+  if (action == a->direction)
+  {
+    /*
+     * Round towards the new interval, so the average converges. max is at
+     * most 32767, so this can't overflow.
+     */
+    interval = (a->interval + interval + (interval > a->interval)) >> 1;
+  }
+  else
+  {
+    interval = max;
+    a->fraction = ENCODER_ACCEL_ONE / 2;
+    a->direction = (encoder_byte_t)action;
+  }
+
+  a->last = now;
+  a->interval = interval;
+
+  return interval;
+}
+
+/*
+ * Apply the multiplier to a single step, carrying over the fractional
+ * part.
+ */
+static int encoder_internal_accel_step(encoder_accel* a,
+                                       enum encoder_action action,
+                                       unsigned multiplier)
+{
+  unsigned const sum = a->fraction + multiplier;
+  int const increment = (int)(sum >> 8);
+
+  a->fraction = (encoder_byte_t)(sum & 0xFF);
+
+  return action == ENCODER_ACTION_TURN_CW ? increment : -increment;
+}
+
+int encoder_accel_update(encoder_accel* a, encoder_accel_curve const* c,
+                         enum encoder_action action, unsigned now)
+{
+  unsigned interval;
+
+  if (action == ENCODER_ACTION_NONE)
+  {
+    return 0;
+  }
+
+  interval = encoder_internal_accel_interval(a, c, action, now);
+
+  return encoder_internal_accel_step(a, action,
+                                     c->table[interval >> c->shift]);
+}
+
+int encoder_accel_update_linear(encoder_accel* a,
+                                encoder_accel_curve const* c,
+                                enum encoder_action action, unsigned now)
+{
+  unsigned interval, index, offset, multiplier;
+
+  if (action == ENCODER_ACTION_NONE)
+  {
+    return 0;
+  }
+
+  interval = encoder_internal_accel_interval(a, c, action, now);
+  index = interval >> c->shift;
+  offset = interval & ((1u << c->shift) - 1);
+  multiplier = c->table[index];
+
+  if (offset != 0)
+  {
+    unsigned const next = c->table[index + 1];
+
+    /* use long to keep the product in range for 16-bit int */
+    if (next >= multiplier)
+    {
+      multiplier += (unsigned)((long)(next - multiplier) * offset >> c->shift);
+    }
+    else
+    {
+      multiplier -= (unsigned)((long)(multiplier - next) * offset >> c->shift);
+    }
+  }
+
+  return encoder_internal_accel_step(a, action, multiplier);
+}
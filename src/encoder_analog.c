@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <rotaryencoder/analog.h>
+
+#include "batch_internal.h"
+
+/*
+ * Compute the set (sample >= high) and reset (sample < low) events for a
+ * block of 32 frames, in the packed layout.
+ */
+static void encoder_internal_analog_events(encoder_analog const* a,
+                                           uint16_t const* x, size_t stride,
+                                           uint64_t* set, uint64_t* reset)
+{
+  uint64_t s = 0, r = 0;
+
+#ifdef __SSE2__
+  if (stride == 2)
+  {
+    /* interleaved A/B samples map directly onto the packed layout */
+    __m128i const bias = _mm_set1_epi16((short)0x8000);
+    __m128i const high = _mm_xor_si128(
+        _mm_set1_epi32((int)(a->high[0] | (uint32_t)a->high[1] << 16)), bias);
+    __m128i const low = _mm_xor_si128(
+        _mm_set1_epi32((int)(a->low[0] | (uint32_t)a->low[1] << 16)), bias);
+
+    for (unsigned i = 0; i < 4; ++i, x += 16)
+    {
+      __m128i const x0 =
+          _mm_xor_si128(_mm_loadu_si128((__m128i const*)x), bias);
+      __m128i const x1 =
+          _mm_xor_si128(_mm_loadu_si128((__m128i const*)(x + 8)), bias);
+      unsigned const below_high = (unsigned)_mm_movemask_epi8(_mm_packs_epi16(
+          _mm_cmplt_epi16(x0, high), _mm_cmplt_epi16(x1, high)));
+      unsigned const below_low = (unsigned)_mm_movemask_epi8(_mm_packs_epi16(
+          _mm_cmplt_epi16(x0, low), _mm_cmplt_epi16(x1, low)));
+
+      s |= (uint64_t)(~below_high & 0xFFFF) << 16 * i;
+      r |= (uint64_t)below_low << 16 * i;
+    }
+
+    *set = s;
+    *reset = r;
+
+    return;
+  }
+#endif
+
+  for (unsigned k = 0; k < 64; k += 2, x += stride)
+  {
+    s |= (uint64_t)(x[0] >= a->high[0]) << k |
+         (uint64_t)(x[1] >= a->high[1]) << (k + 1);
+    r |= (uint64_t)(x[0] < a->low[0]) << k |
+         (uint64_t)(x[1] < a->low[1]) << (k + 1);
+  }
+
+  *set = s;
+  *reset = r;
+}
+
+static uint64_t encoder_internal_analog_word(encoder_analog* a,
+                                             uint16_t const* samples,
+                                             size_t stride)
+{
+  uint64_t set, reset, terminals;
+
+  encoder_internal_analog_events(a, samples, stride, &set, &reset);
+
+  terminals = encoder_internal_batch_fill(
+                  set & ENCODER_INTERNAL_BATCH_EVEN_BITS,
+                  reset & ENCODER_INTERNAL_BATCH_EVEN_BITS,
+                  ENCODER_INTERNAL_BATCH_EVEN_BITS, a->terminal & 1) |
+              encoder_internal_batch_fill(
+                  set & ENCODER_INTERNAL_BATCH_ODD_BITS,
+                  reset & ENCODER_INTERNAL_BATCH_ODD_BITS,
+                  ENCODER_INTERNAL_BATCH_ODD_BITS, a->terminal & 2);
+
+  a->terminal = (encoder_byte_t)(terminals >> 62);
+
+  return terminals;
+}
+
+void encoder_analog_pack(encoder_analog* a, uint16_t const* samples,
+                         size_t stride, uint64_t* terminals, size_t words)
+{
+  for (size_t i = 0; i < words; ++i, samples += 32 * stride)
+  {
+    terminals[i] = encoder_internal_analog_word(a, samples, stride);
+  }
+}
+
+encoder_position_t encoder_analog_update_batch_tt(
+    encoder_analog* a, encoder_state* s, uint16_t const* samples,
+    size_t stride, uint64_t* actions, size_t words,
+    encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+{
+  encoder_position_t delta = 0;
+
+  for (size_t i = 0; i < words; ++i, samples += 32 * stride)
+  {
+    uint64_t const terminals = encoder_internal_analog_word(a, samples, stride);
+
+    delta += encoder_batch_update_tt(
+        s, &terminals, actions ? &actions[i] : NULL, 1, table);
+  }
+
+  return delta;
+}
+
+/*
+ * Run the CORDIC of encoder_cordic_atan2() on `n` vectors. The SIMD path
+ * replaces the branches with sign masks, so it computes exactly the same
+ * angles as the scalar path.
+ */
+static void encoder_internal_cordic_block(int32_t const* x, int32_t const* y,
+                                          uint32_t* angle, size_t n)
+{
+  size_t k = 0;
+
+#ifdef __SSE2__
+  __m128i const half_turn = _mm_set1_epi32(1 << 23);
+  __m128i const bias = _mm_set1_epi32((1 << 24) + 128);
+  __m128i const low16 = _mm_set1_epi32(0xFFFF);
+
+  for (; k + 4 <= n; k += 4)
+  {
+    __m128i vx = _mm_slli_epi32(_mm_loadu_si128((__m128i const*)(x + k)),
+                                ENCODER_CORDIC_INPUT_SHIFT);
+    __m128i vy = _mm_slli_epi32(_mm_loadu_si128((__m128i const*)(y + k)),
+                                ENCODER_CORDIC_INPUT_SHIFT);
+    __m128i const neg = _mm_srai_epi32(vx, 31);
+    __m128i z = _mm_and_si128(neg, half_turn);
+
+    vx = _mm_sub_epi32(_mm_xor_si128(vx, neg), neg);
+    vy = _mm_sub_epi32(_mm_xor_si128(vy, neg), neg);
+
+    for (int i = 0; i < ENCODER_CORDIC_ITERATIONS; ++i)
+    {
+      __m128i const shift = _mm_cvtsi32_si128(i);
+      __m128i const s = _mm_srai_epi32(vy, 31);
+      __m128i const dx = _mm_sra_epi32(vy, shift);
+      __m128i const dy = _mm_sra_epi32(vx, shift);
+      __m128i const t = _mm_set1_epi32((int)encoder_cordic_table[i]);
+
+      vx = _mm_add_epi32(vx, _mm_sub_epi32(_mm_xor_si128(dx, s), s));
+      vy = _mm_sub_epi32(vy, _mm_sub_epi32(_mm_xor_si128(dy, s), s));
+      z = _mm_add_epi32(z, _mm_sub_epi32(_mm_xor_si128(t, s), s));
+    }
+
+    _mm_storeu_si128(
+        (__m128i*)(angle + k),
+        _mm_and_si128(_mm_srli_epi32(_mm_add_epi32(z, bias), 8), low16));
+  }
+#endif
+
+  for (; k < n; ++k)
+  {
+    angle[k] = encoder_cordic_atan2(y[k], x[k]);
+  }
+}
+
+void encoder_interpolator_update_batch(encoder_interpolator* ip,
+                                       uint16_t const* samples, size_t stride,
+                                       encoder_position_t* positions,
+                                       size_t frames)
+{
+  enum
+  {
+    block = 64
+  };
+  int32_t x[block], y[block];
+  uint32_t angle[block];
+
+  while (frames > 0)
+  {
+    size_t const n = frames < block ? frames : block;
+
+    for (size_t k = 0; k < n; ++k)
+    {
+      x[k] = (int32_t)samples[k * stride] - ip->offset_a;
+      y[k] = (int32_t)samples[k * stride + 1] - ip->offset_b;
+    }
+
+    encoder_internal_cordic_block(x, y, angle, n);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+      positions[k] = encoder_internal_interpolate(
+          ip, (int)samples[k * stride], (int)samples[k * stride + 1],
+          angle[k]);
+    }
+
+    samples += n * stride;
+    positions += n;
+    frames -= n;
+  }
+}
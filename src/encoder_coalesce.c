@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include <rotaryencoder/coalesce.h>
+
+enum
+{
+  ENCODER_INTERNAL_CACHE_LINE = 64
+};
+
+/*
+ * The producer's accumulators are kept in dense arrays separate from the
+ * mailboxes, so the producer only touches shared cache lines on handoff.
+ */
+struct encoder_coalescer
+{
+  void* memory;
+
+  /* producer only */
+  encoder_position_t* pending;
+  uint64_t* since;
+  uint64_t latency;
+  unsigned long threshold;
+  uint64_t releases;
+  size_t count;
+
+  /* shared */
+  _Atomic encoder_position_t* mailbox;
+  _Atomic uint64_t* ready;
+};
+
+static size_t encoder_internal_align(size_t size)
+{
+  return (size + ENCODER_INTERNAL_CACHE_LINE - 1) &
+         ~(size_t)(ENCODER_INTERNAL_CACHE_LINE - 1);
+}
+
+encoder_coalescer* encoder_coalescer_create(size_t count, uint64_t latency,
+                                            unsigned long threshold)
+{
+  encoder_coalescer* c = calloc(1, sizeof(*c));
+  size_t const words = (count + 63) / 64;
+  size_t const since = encoder_internal_align(count * sizeof(*c->pending));
+  size_t const mailbox =
+      since + encoder_internal_align(count * sizeof(*c->since));
+  size_t const ready =
+      mailbox + encoder_internal_align(count * sizeof(*c->mailbox));
+  size_t const size =
+      ready + encoder_internal_align(words * sizeof(*c->ready));
+  char* memory;
+
+  if (!c)
+  {
+    return NULL;
+  }
+
+  /* a single block, with the shared part starting on a new cache line */
+  memory = aligned_alloc(ENCODER_INTERNAL_CACHE_LINE,
+                         size ? size : ENCODER_INTERNAL_CACHE_LINE);
+
+  if (!memory)
+  {
+    free(c);
+    return NULL;
+  }
+
+  c->memory = memory;
+  c->pending = (encoder_position_t*)memory;
+  c->since = (uint64_t*)(memory + since);
+  c->mailbox = (_Atomic encoder_position_t*)(memory + mailbox);
+  c->ready = (_Atomic uint64_t*)(memory + ready);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    c->pending[i] = 0;
+    c->since[i] = 0;
+    atomic_init(&c->mailbox[i], 0);
+  }
+
+  for (size_t i = 0; i < words; ++i)
+  {
+    atomic_init(&c->ready[i], 0);
+  }
+
+  c->latency = latency;
+  c->threshold = threshold;
+  c->count = count;
+
+  return c;
+}
+
+void encoder_coalescer_destroy(encoder_coalescer* c)
+{
+  if (c)
+  {
+    free(c->memory);
+    free(c);
+  }
+}
+
+static void encoder_internal_coalesce_release(encoder_coalescer* c, size_t i)
+{
+  atomic_fetch_add_explicit(&c->mailbox[i], c->pending[i],
+                            memory_order_relaxed);
+  atomic_fetch_or_explicit(&c->ready[i / 64], UINT64_C(1) << i % 64,
+                           memory_order_release);
+  c->pending[i] = 0;
+  ++c->releases;
+}
+
+void encoder_coalescer_add(encoder_coalescer* c, size_t encoder,
+                           encoder_position_t delta, uint64_t now)
+{
+  encoder_position_t const pending = c->pending[encoder] + delta;
+
+  if (c->pending[encoder] == 0)
+  {
+    c->since[encoder] = now;
+  }
+
+  c->pending[encoder] = pending;
+
+  if (pending != 0 &&
+      ((unsigned long)labs(pending) >= c->threshold ||
+       now - c->since[encoder] >= c->latency))
+  {
+    encoder_internal_coalesce_release(c, encoder);
+  }
+}
+
+void encoder_coalescer_poll(encoder_coalescer* c, uint64_t now)
+{
+  for (size_t i = 0; i < c->count; ++i)
+  {
+    if (c->pending[i] != 0 && now - c->since[i] >= c->latency)
+    {
+      encoder_internal_coalesce_release(c, i);
+    }
+  }
+}
+
+void encoder_coalescer_flush(encoder_coalescer* c)
+{
+  for (size_t i = 0; i < c->count; ++i)
+  {
+    if (c->pending[i] != 0)
+    {
+      encoder_internal_coalesce_release(c, i);
+    }
+  }
+}
+
+uint64_t encoder_coalescer_releases(encoder_coalescer const* c)
+{
+  return c->releases;
+}
+
+size_t encoder_coalescer_drain(encoder_coalescer* c,
+                               encoder_position_t* deltas)
+{
+  size_t changed = 0;
+
+  for (size_t w = 0; w < (c->count + 63) / 64; ++w)
+  {
+    uint64_t ready = atomic_exchange_explicit(&c->ready[w], 0,
+                                              memory_order_acquire);
+
+    while (ready)
+    {
+      size_t const i = w * 64 + (size_t)__builtin_ctzll(ready);
+      encoder_position_t const delta = atomic_exchange_explicit(
+          &c->mailbox[i], 0, memory_order_relaxed);
+
+      /*
+       * The delta may already have been picked up along with an earlier
+       * release, or the releases may have cancelled out.
+       */
+      if (delta != 0)
+      {
+        deltas[i] += delta;
+        ++changed;
+      }
+
+      ready &= ready - 1;
+    }
+  }
+
+  return changed;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/index_encoder.h>
+
+enum
+{
+  EI_ARM,
+  EI_FIR,
+
+  EI_EVT = EI_FIR | ENCODER_INDEX_EVENT
+};
+
+ENCODER_CONST_MEMORY encoder_byte_t encoder_index_gate_table[2][8] = {
+    /* clang-format off */
+    /*            000     001     010     011     100     101     110     111   */
+    /* EI_ARM */ {EI_ARM, EI_ARM, EI_ARM, EI_ARM, EI_ARM, EI_ARM, EI_ARM, EI_EVT},
+    /* EI_FIR */ {EI_ARM, EI_ARM, EI_ARM, EI_ARM, EI_FIR, EI_FIR, EI_FIR, EI_FIR}
+    /* clang-format on */
+};
+
+encoder_fast_byte_t encoder_index_update(encoder_index_state* s,
+                                         encoder_fast_byte_t terminal,
+                                         enum encoder_action action)
+{
+  encoder_fast_byte_t const gate =
+      encoder_index_gate_table[s->flags & ENCODER_INDEX_GATE_MASK]
+                              [terminal & 0x7];
+
+  if (action == ENCODER_ACTION_TURN_CW)
+  {
+    ++s->position;
+  }
+  else if (action == ENCODER_ACTION_TURN_CCW)
+  {
+    --s->position;
+  }
+
+  s->flags = (s->flags & ~ENCODER_INDEX_GATE_MASK) |
+             (gate & ENCODER_INDEX_GATE_MASK);
+
+  if ((gate & ENCODER_INDEX_EVENT) == 0)
+  {
+    return 0;
+  }
+
+  if (s->flags & ENCODER_INDEX_HOMING)
+  {
+    s->position = s->home_position;
+
+    if ((s->flags & ENCODER_INDEX_HOMING_CONTINUOUS) == 0)
+    {
+      s->flags &= ~ENCODER_INDEX_HOMING;
+    }
+  }
+
+  s->index_position = s->position;
+  s->flags |= ENCODER_INDEX_LATCHED;
+
+  return 1;
+}
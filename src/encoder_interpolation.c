@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/interpolation.h>
+#include <rotaryencoder/simple_encoder.h>
+
+/* atan(2^-i) in units of 1/2^24 turns */
+ENCODER_CONST_MEMORY long encoder_cordic_table[ENCODER_CORDIC_ITERATIONS] = {
+    2097152L, 1238021L, 654136L, 332050L, 166669L, 83416L, 41718L, 20860L,
+    10430L,   5215L,    2608L,   1304L,   652L,    326L,   163L,   81L};
+
+unsigned encoder_cordic_atan2(int y, int x)
+{
+  long lx = (long)x * (1L << ENCODER_CORDIC_INPUT_SHIFT);
+  long ly = (long)y * (1L << ENCODER_CORDIC_INPUT_SHIFT);
+  long z = 0;
+  encoder_fast_byte_t i;
+
+  /* CORDIC only converges for angles within +/-90 degrees */
+  if (lx < 0)
+  {
+    lx = -lx;
+    ly = -ly;
+    z = 1L << 23;
+  }
+
+  for (i = 0; i < ENCODER_CORDIC_ITERATIONS; ++i)
+  {
+    long const dx = ly >> i;
+    long const dy = lx >> i;
+
+    if (ly < 0)
+    {
+      lx -= dx;
+      ly += dy;
+      z -= encoder_cordic_table[i];
+    }
+    else
+    {
+      lx += dx;
+      ly -= dy;
+      z += encoder_cordic_table[i];
+    }
+  }
+
+  /* add a full turn to keep z positive, then round to 16 bits */
+  return (unsigned)(((z + (1L << 24) + 128) >> 8) & 0xFFFF);
+}
+
+static encoder_fast_byte_t encoder_internal_threshold(encoder_fast_byte_t bit,
+                                                      int x, int hysteresis)
+{
+  if (x >= hysteresis)
+  {
+    return bit;
+  }
+
+  return x < -hysteresis ? 0 : 0xFF;
+}
+
+void encoder_interpolator_init(encoder_interpolator* ip, int offset_a,
+                               int offset_b, int hysteresis, int a, int b)
+{
+  unsigned const angle = encoder_cordic_atan2(b - offset_b, a - offset_a);
+
+  ip->offset_a = offset_a;
+  ip->offset_b = offset_b;
+  ip->hysteresis = hysteresis;
+  ip->terminal = (encoder_byte_t)((a >= offset_a ? ENCODER_TERMINAL_A : 0) |
+                                  (b >= offset_b ? ENCODER_TERMINAL_B : 0));
+  ip->count = (encoder_position_t)(angle >> 14);
+  encoder_simple_quarter_step_init(&ip->state, ip->terminal);
+}
+
+encoder_position_t encoder_internal_interpolate(encoder_interpolator* ip,
+                                                int a, int b, unsigned angle)
+{
+  encoder_fast_byte_t const ta =
+      encoder_internal_threshold(ENCODER_TERMINAL_A, a - ip->offset_a,
+                                 ip->hysteresis);
+  encoder_fast_byte_t const tb =
+      encoder_internal_threshold(ENCODER_TERMINAL_B, b - ip->offset_b,
+                                 ip->hysteresis);
+  encoder_fast_byte_t quadrant;
+
+  /* 0xFF means the signal is within the hysteresis band */
+  ip->terminal = (encoder_byte_t)(
+      (ta == 0xFF ? ip->terminal & ENCODER_TERMINAL_A : ta) |
+      (tb == 0xFF ? ip->terminal & ENCODER_TERMINAL_B : tb));
+
+  switch (encoder_simple_quarter_step_update(&ip->state, ip->terminal))
+  {
+  case ENCODER_ACTION_TURN_CW:
+    ++ip->count;
+    break;
+  case ENCODER_ACTION_TURN_CCW:
+    --ip->count;
+    break;
+  case ENCODER_ACTION_NONE:
+    break;
+  }
+
+  /*
+   * Due to the hysteresis, the count lags behind the angle around the
+   * quadrant boundaries. Move it to the nearest quarter step that matches
+   * the quadrant of the angle.
+   */
+  quadrant = (encoder_fast_byte_t)(((angle >> 14) - (unsigned)ip->count + 1) &
+                                   3);
+
+  return (ip->count + (encoder_position_t)quadrant - 1) * 16384 +
+         (encoder_position_t)(angle & 0x3FFF);
+}
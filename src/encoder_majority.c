@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/majority.h>
+
+#include "batch_internal.h"
+
+enum
+{
+  /* enough for counts up to 32 */
+  ENCODER_INTERNAL_MAJORITY_PLANES = 6,
+  ENCODER_INTERNAL_MAJORITY_CHUNK = 64
+};
+
+/*
+ * Returns a mask of all bits where the bit-sliced count in `plane` is at
+ * least `threshold`, comparing from the most significant plane down.
+ */
+static uint64_t encoder_internal_majority_ge(uint64_t const* plane,
+                                             unsigned threshold)
+{
+  uint64_t gt = 0, eq = ~UINT64_C(0);
+
+  for (int p = ENCODER_INTERNAL_MAJORITY_PLANES - 1; p >= 0; --p)
+  {
+    if (threshold >> p & 1)
+    {
+      eq &= plane[p];
+    }
+    else
+    {
+      gt |= eq & plane[p];
+    }
+  }
+
+  return gt | eq;
+}
+
+static uint64_t encoder_internal_majority_word(encoder_majority* m,
+                                               uint64_t in)
+{
+  uint64_t plane[ENCODER_INTERNAL_MAJORITY_PLANES] = {in};
+  uint64_t set, reset, terminals;
+
+  /*
+   * Add the samples 1 to window - 1 positions back, taken from the previous
+   * word where necessary, to the bit-sliced counters.
+   */
+  for (unsigned k = 1; k < m->window; ++k)
+  {
+    uint64_t carry = in << 2 * k | m->history >> (64 - 2 * k);
+
+    for (int p = 0; p < ENCODER_INTERNAL_MAJORITY_PLANES && carry; ++p)
+    {
+      uint64_t const next = plane[p] & carry;
+      plane[p] ^= carry;
+      carry = next;
+    }
+  }
+
+  m->history = in;
+
+  set = encoder_internal_majority_ge(plane, m->high);
+  reset = ~encoder_internal_majority_ge(plane, m->low);
+
+  terminals = encoder_internal_batch_fill(
+                  set & ENCODER_INTERNAL_BATCH_EVEN_BITS,
+                  reset & ENCODER_INTERNAL_BATCH_EVEN_BITS,
+                  ENCODER_INTERNAL_BATCH_EVEN_BITS, m->terminal & 1) |
+              encoder_internal_batch_fill(
+                  set & ENCODER_INTERNAL_BATCH_ODD_BITS,
+                  reset & ENCODER_INTERNAL_BATCH_ODD_BITS,
+                  ENCODER_INTERNAL_BATCH_ODD_BITS, m->terminal & 2);
+
+  m->terminal = (encoder_byte_t)(terminals >> 62);
+
+  return terminals;
+}
+
+void encoder_majority_filter(encoder_majority* m, uint64_t const* in,
+                             uint64_t* out, size_t words)
+{
+  for (size_t i = 0; i < words; ++i)
+  {
+    out[i] = encoder_internal_majority_word(m, in[i]);
+  }
+}
+
+encoder_position_t encoder_majority_update_batch_tt(
+    encoder_majority* m, encoder_state* s, uint64_t const* samples,
+    uint64_t* actions, size_t words,
+    encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+{
+  uint64_t filtered[ENCODER_INTERNAL_MAJORITY_CHUNK];
+  encoder_position_t delta = 0;
+
+  /* filter in chunks small enough to stay in L1 for the decoder */
+  while (words > 0)
+  {
+    size_t const n = words < ENCODER_INTERNAL_MAJORITY_CHUNK
+                         ? words
+                         : ENCODER_INTERNAL_MAJORITY_CHUNK;
+
+    encoder_majority_filter(m, samples, filtered, n);
+    delta += encoder_batch_update_tt(s, filtered, actions, n, table);
+
+    samples += n;
+    actions = actions ? actions + n : NULL;
+    words -= n;
+  }
+
+  return delta;
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <rotaryencoder/parallel.h>
+
+enum
+{
+  ENCODER_INTERNAL_PARALLEL_CHECKPOINT = 64,
+  ENCODER_INTERNAL_PARALLEL_CHUNK = 64 * ENCODER_INTERNAL_PARALLEL_CHECKPOINT
+};
+
+/*
+ * For each chunk, the state and the step count since the start of the
+ * chunk are recorded every ENCODER_INTERNAL_PARALLEL_CHECKPOINT words
+ * during the speculative run, so the re-run can detect convergence.
+ */
+struct encoder_internal_parallel_chunk
+{
+  size_t job;
+  size_t first;
+  size_t words;
+  encoder_state* checkpoint_state;
+  encoder_position_t* checkpoint_delta;
+};
+
+/*
+ * The range of tasks still owned by a worker, as begin << 32 | end. The
+ * owner takes tasks from the front, and thieves take the back half, both
+ * using CAS on the whole range.
+ */
+struct encoder_internal_parallel_worker
+{
+  _Alignas(64) _Atomic uint64_t range;
+  size_t steals;
+};
+
+struct encoder_internal_parallel_pool
+{
+  struct encoder_internal_parallel_worker* workers;
+  unsigned count;
+  void (*run)(struct encoder_internal_parallel_pool*, size_t);
+  encoder_parallel_job* jobs;
+  struct encoder_internal_parallel_chunk* chunks;
+  size_t* job_chunks;
+  _Atomic size_t resyncs;
+};
+
+struct encoder_internal_parallel_thread
+{
+  struct encoder_internal_parallel_pool* pool;
+  unsigned index;
+};
+
+static uint64_t encoder_internal_parallel_range(size_t begin, size_t end)
+{
+  return (uint64_t)begin << 32 | (uint64_t)end;
+}
+
+/*
+ * Take the back half of another worker's tasks. Returns zero if all
+ * workers have run out of tasks.
+ */
+static int encoder_internal_parallel_steal(
+    struct encoder_internal_parallel_pool* pool, unsigned self)
+{
+  struct encoder_internal_parallel_worker* me = &pool->workers[self];
+
+  for (unsigned k = 1; k < pool->count; ++k)
+  {
+    struct encoder_internal_parallel_worker* victim =
+        &pool->workers[(self + k) % pool->count];
+    uint64_t range =
+        atomic_load_explicit(&victim->range, memory_order_acquire);
+
+    while ((uint32_t)(range >> 32) < (uint32_t)range)
+    {
+      size_t const begin = (size_t)(range >> 32);
+      size_t const end = (size_t)(uint32_t)range;
+      size_t const mid = begin + (end - begin) / 2;
+
+      if (atomic_compare_exchange_weak_explicit(
+              &victim->range, &range,
+              encoder_internal_parallel_range(begin, mid),
+              memory_order_acq_rel, memory_order_acquire))
+      {
+        atomic_store_explicit(&me->range,
+                              encoder_internal_parallel_range(mid, end),
+                              memory_order_release);
+        ++me->steals;
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+static void* encoder_internal_parallel_work(void* arg)
+{
+  struct encoder_internal_parallel_thread const* t = arg;
+  struct encoder_internal_parallel_pool* pool = t->pool;
+  struct encoder_internal_parallel_worker* me = &pool->workers[t->index];
+
+  do
+  {
+    uint64_t range = atomic_load_explicit(&me->range, memory_order_acquire);
+
+    while ((uint32_t)(range >> 32) < (uint32_t)range)
+    {
+      size_t const task = (size_t)(range >> 32);
+
+      if (atomic_compare_exchange_weak_explicit(
+              &me->range, &range,
+              encoder_internal_parallel_range(task + 1, (uint32_t)range),
+              memory_order_acq_rel, memory_order_acquire))
+      {
+        pool->run(pool, task);
+      }
+    }
+  } while (encoder_internal_parallel_steal(pool, t->index));
+
+  return NULL;
+}
+
+/*
+ * Run tasks 0 to `tasks` - 1 on all workers, with the calling thread
+ * acting as the first worker.
+ */
+static void encoder_internal_parallel_run(
+    struct encoder_internal_parallel_pool* pool,
+    struct encoder_internal_parallel_thread* threads, pthread_t* handles,
+    size_t tasks, void (*run)(struct encoder_internal_parallel_pool*, size_t))
+{
+  unsigned started = 0;
+
+  pool->run = run;
+
+  for (unsigned w = 0; w < pool->count; ++w)
+  {
+    atomic_store_explicit(
+        &pool->workers[w].range,
+        encoder_internal_parallel_range(tasks * w / pool->count,
+                                        tasks * (w + 1) / pool->count),
+        memory_order_relaxed);
+  }
+
+  for (unsigned w = 1; w < pool->count; ++w)
+  {
+    threads[w].pool = pool;
+    threads[w].index = w;
+
+    /* the tasks of workers that can't be started are stolen by others */
+    if (pthread_create(&handles[started], NULL,
+                       encoder_internal_parallel_work, &threads[w]) == 0)
+    {
+      ++started;
+    }
+  }
+
+  threads[0].pool = pool;
+  threads[0].index = 0;
+  encoder_internal_parallel_work(&threads[0]);
+
+  for (unsigned i = 0; i < started; ++i)
+  {
+    pthread_join(handles[i], NULL);
+  }
+}
+
+static void encoder_internal_parallel_speculate(
+    struct encoder_internal_parallel_pool* pool, size_t task)
+{
+  struct encoder_internal_parallel_chunk const* c = &pool->chunks[task];
+  encoder_parallel_job const* job = &pool->jobs[c->job];
+  encoder_state state = *job->state;
+  encoder_position_t delta = 0;
+
+  for (size_t w = 0, i = 0; w < c->words;
+       w += ENCODER_INTERNAL_PARALLEL_CHECKPOINT, ++i)
+  {
+    size_t const n = c->words - w < ENCODER_INTERNAL_PARALLEL_CHECKPOINT
+                         ? c->words - w
+                         : ENCODER_INTERNAL_PARALLEL_CHECKPOINT;
+
+    delta += encoder_batch_update_tt(
+        &state, job->samples + c->first + w,
+        job->actions ? job->actions + c->first + w : NULL, n, job->table);
+
+    c->checkpoint_state[i] = state;
+    c->checkpoint_delta[i] = delta;
+  }
+}
+
+/*
+ * Chain the chunks of a job, re-running each chunk from its actual start
+ * state until it converges with the speculative run.
+ */
+static void encoder_internal_parallel_resolve(
+    struct encoder_internal_parallel_pool* pool, size_t task)
+{
+  encoder_parallel_job* job = &pool->jobs[task];
+  encoder_state state = *job->state;
+  encoder_position_t total = 0;
+
+  for (size_t k = pool->job_chunks[task]; k < pool->job_chunks[task + 1]; ++k)
+  {
+    struct encoder_internal_parallel_chunk const* c = &pool->chunks[k];
+    size_t const checkpoints =
+        (c->words + ENCODER_INTERNAL_PARALLEL_CHECKPOINT - 1) /
+        ENCODER_INTERNAL_PARALLEL_CHECKPOINT;
+    encoder_position_t delta = 0;
+    size_t i = 0;
+
+    /* the first chunk started from the actual state */
+    if (k > pool->job_chunks[task] && state != *job->state)
+    {
+      atomic_fetch_add_explicit(&pool->resyncs, 1, memory_order_relaxed);
+
+      for (; i < checkpoints; ++i)
+      {
+        size_t const w = i * ENCODER_INTERNAL_PARALLEL_CHECKPOINT;
+        size_t const n = c->words - w < ENCODER_INTERNAL_PARALLEL_CHECKPOINT
+                             ? c->words - w
+                             : ENCODER_INTERNAL_PARALLEL_CHECKPOINT;
+
+        delta += encoder_batch_update_tt(
+            &state, job->samples + c->first + w,
+            job->actions ? job->actions + c->first + w : NULL, n,
+            job->table);
+
+        if (state == c->checkpoint_state[i])
+        {
+          break;
+        }
+      }
+
+      if (i == checkpoints)
+      {
+        /* never converged, so the re-run covered the whole chunk */
+        total += delta;
+        continue;
+      }
+
+      delta -= c->checkpoint_delta[i];
+    }
+
+    if (checkpoints > 0)
+    {
+      total += delta + c->checkpoint_delta[checkpoints - 1];
+      state = c->checkpoint_state[checkpoints - 1];
+    }
+  }
+
+  *job->state = state;
+  job->delta = total;
+}
+
+static double encoder_internal_parallel_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int encoder_parallel_decode(encoder_parallel_job* jobs, size_t count,
+                            unsigned threads, size_t chunk_words,
+                            encoder_parallel_stats* stats)
+{
+  struct encoder_internal_parallel_pool pool;
+  struct encoder_internal_parallel_thread* thread_args;
+  pthread_t* handles;
+  size_t chunks = 0, checkpoints = 0;
+  uint64_t samples = 0;
+  encoder_state* checkpoint_state;
+  encoder_position_t* checkpoint_delta;
+  double const t0 = encoder_internal_parallel_now();
+
+  if (threads == 0)
+  {
+    long const cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cpus > 0 ? (unsigned)cpus : 1;
+  }
+
+  /* whole checkpoints per chunk */
+  chunk_words = chunk_words ? chunk_words : ENCODER_INTERNAL_PARALLEL_CHUNK;
+  chunk_words = (chunk_words + ENCODER_INTERNAL_PARALLEL_CHECKPOINT - 1) /
+                ENCODER_INTERNAL_PARALLEL_CHECKPOINT *
+                ENCODER_INTERNAL_PARALLEL_CHECKPOINT;
+
+  for (size_t j = 0; j < count; ++j)
+  {
+    chunks += (jobs[j].words + chunk_words - 1) / chunk_words;
+    checkpoints += (jobs[j].words + ENCODER_INTERNAL_PARALLEL_CHECKPOINT - 1) /
+                   ENCODER_INTERNAL_PARALLEL_CHECKPOINT;
+    samples += (uint64_t)jobs[j].words * 32;
+  }
+
+  pool.count = threads;
+  pool.jobs = jobs;
+  pool.workers = aligned_alloc(64, threads * sizeof(*pool.workers));
+  pool.chunks = malloc((chunks + 1) * sizeof(*pool.chunks));
+  pool.job_chunks = malloc((count + 1) * sizeof(*pool.job_chunks));
+  thread_args = malloc(threads * sizeof(*thread_args));
+  handles = malloc(threads * sizeof(*handles));
+  checkpoint_state = malloc((checkpoints + 1) * sizeof(*checkpoint_state));
+  checkpoint_delta = malloc((checkpoints + 1) * sizeof(*checkpoint_delta));
+  atomic_init(&pool.resyncs, 0);
+
+  if (!pool.workers || !pool.chunks || !pool.job_chunks || !thread_args ||
+      !handles || !checkpoint_state || !checkpoint_delta ||
+      chunks > UINT32_MAX)
+  {
+    free(pool.workers);
+    free(pool.chunks);
+    free(pool.job_chunks);
+    free(thread_args);
+    free(handles);
+    free(checkpoint_state);
+    free(checkpoint_delta);
+    return -1;
+  }
+
+  chunks = 0;
+  checkpoints = 0;
+
+  for (size_t j = 0; j < count; ++j)
+  {
+    pool.job_chunks[j] = chunks;
+
+    for (size_t first = 0; first < jobs[j].words; first += chunk_words)
+    {
+      struct encoder_internal_parallel_chunk* c = &pool.chunks[chunks++];
+
+      c->job = j;
+      c->first = first;
+      c->words = jobs[j].words - first < chunk_words ? jobs[j].words - first
+                                                     : chunk_words;
+      c->checkpoint_state = &checkpoint_state[checkpoints];
+      c->checkpoint_delta = &checkpoint_delta[checkpoints];
+      checkpoints += (c->words + ENCODER_INTERNAL_PARALLEL_CHECKPOINT - 1) /
+                     ENCODER_INTERNAL_PARALLEL_CHECKPOINT;
+    }
+  }
+
+  pool.job_chunks[count] = chunks;
+
+  for (unsigned w = 0; w < threads; ++w)
+  {
+    pool.workers[w].steals = 0;
+  }
+
+  encoder_internal_parallel_run(&pool, thread_args, handles, chunks,
+                                encoder_internal_parallel_speculate);
+  encoder_internal_parallel_run(&pool, thread_args, handles, count,
+                                encoder_internal_parallel_resolve);
+
+  if (stats)
+  {
+    stats->samples = samples;
+    stats->chunks = chunks;
+    stats->steals = 0;
+    for (unsigned w = 0; w < threads; ++w)
+    {
+      stats->steals += pool.workers[w].steals;
+    }
+    stats->resyncs = atomic_load(&pool.resyncs);
+    stats->seconds = encoder_internal_parallel_now() - t0;
+    stats->samples_per_second =
+        stats->seconds > 0 ? (double)samples / stats->seconds : 0.0;
+  }
+
+  free(pool.workers);
+  free(pool.chunks);
+  free(pool.job_chunks);
+  free(thread_args);
+  free(handles);
+  free(checkpoint_state);
+  free(checkpoint_delta);
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include <rotaryencoder/queue.h>
+
+enum
+{
+  ENCODER_INTERNAL_CACHE_LINE = 64
+};
+
+/*
+ * A slot at position `p` (counting all events ever pushed) holds a valid
+ * event once its sequence number is p + 1. As positions one lap apart use
+ * the same slot, the consumer can't mistake an event of the previous lap
+ * for a new one.
+ *
+ * The reservation counter of the producers and the position of the
+ * consumer are kept on separate cache lines.
+ */
+struct encoder_event_queue
+{
+  void* memory;
+  _Atomic size_t* sequence;
+  encoder_event* events;
+  size_t mask;
+  _Alignas(ENCODER_INTERNAL_CACHE_LINE) _Atomic size_t head;
+  _Alignas(ENCODER_INTERNAL_CACHE_LINE) _Atomic size_t tail;
+};
+
+encoder_event_queue* encoder_event_queue_create(size_t capacity)
+{
+  encoder_event_queue* q;
+  size_t size = 1;
+  size_t events;
+  char* memory;
+
+  while (size < capacity)
+  {
+    size <<= 1;
+  }
+
+  events = (size * sizeof(*q->sequence) + ENCODER_INTERNAL_CACHE_LINE - 1) &
+           ~(size_t)(ENCODER_INTERNAL_CACHE_LINE - 1);
+
+  q = aligned_alloc(ENCODER_INTERNAL_CACHE_LINE, sizeof(*q));
+
+  if (!q)
+  {
+    return NULL;
+  }
+
+  memory = aligned_alloc(ENCODER_INTERNAL_CACHE_LINE,
+                         events + size * sizeof(*q->events));
+
+  if (!memory)
+  {
+    free(q);
+    return NULL;
+  }
+
+  q->memory = memory;
+  q->sequence = (_Atomic size_t*)memory;
+  q->events = (encoder_event*)(memory + events);
+  q->mask = size - 1;
+  atomic_init(&q->head, 0);
+  atomic_init(&q->tail, 0);
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    atomic_init(&q->sequence[i], 0);
+  }
+
+  return q;
+}
+
+void encoder_event_queue_destroy(encoder_event_queue* q)
+{
+  if (q)
+  {
+    free(q->memory);
+    free(q);
+  }
+}
+
+size_t encoder_event_queue_capacity(encoder_event_queue const* q)
+{
+  return q->mask + 1;
+}
+
+size_t encoder_event_queue_push(encoder_event_queue* q,
+                                encoder_event const* events, size_t count)
+{
+  size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  size_t n;
+
+  do
+  {
+    /* the consumer is done with all slots before its position */
+    size_t const free =
+        q->mask + 1 -
+        (head - atomic_load_explicit(&q->tail, memory_order_acquire));
+
+    n = count < free ? count : free;
+
+    if (n == 0)
+    {
+      return 0;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(
+      &q->head, &head, head + n, memory_order_relaxed, memory_order_relaxed));
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    size_t const slot = (head + i) & q->mask;
+
+    q->events[slot] = events[i];
+    atomic_store_explicit(&q->sequence[slot], head + i + 1,
+                          memory_order_release);
+  }
+
+  return n;
+}
+
+size_t encoder_event_queue_pop(encoder_event_queue* q, encoder_event* events,
+                               size_t max)
+{
+  size_t const tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  size_t n = 0;
+
+  while (n < max)
+  {
+    size_t const slot = (tail + n) & q->mask;
+
+    if (atomic_load_explicit(&q->sequence[slot], memory_order_acquire) !=
+        tail + n + 1)
+    {
+      break;
+    }
+
+    events[n++] = q->events[slot];
+  }
+
+  if (n > 0)
+  {
+    atomic_store_explicit(&q->tail, tail + n, memory_order_release);
+  }
+
+  return n;
+}
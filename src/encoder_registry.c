@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rotaryencoder/registry.h>
+
+enum
+{
+  ENCODER_INTERNAL_CACHE_LINE = 64
+};
+
+/*
+ * A shard is a single block, starting with its struct, followed by the
+ * states and the positions, each starting on a new cache line. The size of
+ * the block is rounded up to whole cache lines, so no other allocation can
+ * share its last cache line.
+ */
+struct encoder_registry
+{
+  size_t encoders;
+  size_t count;
+  unsigned flags;
+  _Atomic(encoder_registry_shard*) shards[];
+};
+
+static size_t encoder_internal_registry_align(size_t size)
+{
+  return (size + ENCODER_INTERNAL_CACHE_LINE - 1) &
+         ~(size_t)(ENCODER_INTERNAL_CACHE_LINE - 1);
+}
+
+static encoder_registry_shard*
+encoder_internal_registry_alloc(encoder_registry const* r, size_t s)
+{
+  size_t const first = r->encoders * s / r->count;
+  size_t const count = r->encoders * (s + 1) / r->count - first;
+  size_t const states =
+      encoder_internal_registry_align(sizeof(encoder_registry_shard));
+  size_t const positions =
+      states + encoder_internal_registry_align(count * sizeof(encoder_state));
+  size_t const size = positions + encoder_internal_registry_align(
+                                      count * sizeof(encoder_position_t));
+  char* memory = aligned_alloc(ENCODER_INTERNAL_CACHE_LINE, size);
+  encoder_registry_shard* shard = (encoder_registry_shard*)memory;
+
+  if (!memory)
+  {
+    return NULL;
+  }
+
+  shard->first = first;
+  shard->count = count;
+  shard->states = (encoder_state*)(memory + states);
+  shard->positions = (encoder_position_t*)(memory + positions);
+
+  memset(shard->states, 0, count * sizeof(encoder_state));
+  memset(shard->positions, 0, count * sizeof(encoder_position_t));
+
+  return shard;
+}
+
+encoder_registry* encoder_registry_create(size_t encoders, size_t shards,
+                                          unsigned flags)
+{
+  encoder_registry* r;
+
+  if (shards == 0)
+  {
+    return NULL;
+  }
+
+  r = malloc(sizeof(*r) + shards * sizeof(r->shards[0]));
+
+  if (!r)
+  {
+    return NULL;
+  }
+
+  r->encoders = encoders;
+  r->count = shards;
+  r->flags = flags;
+
+  for (size_t s = 0; s < shards; ++s)
+  {
+    atomic_init(&r->shards[s], NULL);
+  }
+
+  if ((flags & ENCODER_REGISTRY_FIRST_TOUCH) == 0)
+  {
+    for (size_t s = 0; s < shards; ++s)
+    {
+      encoder_registry_shard* shard = encoder_internal_registry_alloc(r, s);
+
+      if (!shard)
+      {
+        encoder_registry_destroy(r);
+        return NULL;
+      }
+
+      atomic_init(&r->shards[s], shard);
+    }
+  }
+
+  return r;
+}
+
+void encoder_registry_destroy(encoder_registry* r)
+{
+  if (r)
+  {
+    for (size_t s = 0; s < r->count; ++s)
+    {
+      free(atomic_load_explicit(&r->shards[s], memory_order_relaxed));
+    }
+
+    free(r);
+  }
+}
+
+encoder_registry_shard* encoder_registry_get_shard(encoder_registry* r,
+                                                   size_t s)
+{
+  encoder_registry_shard* shard =
+      atomic_load_explicit(&r->shards[s], memory_order_acquire);
+
+  if (!shard)
+  {
+    encoder_registry_shard* expected = NULL;
+
+    shard = encoder_internal_registry_alloc(r, s);
+
+    /* in case another thread has been faster */
+    if (shard && !atomic_compare_exchange_strong_explicit(
+                     &r->shards[s], &expected, shard, memory_order_acq_rel,
+                     memory_order_acquire))
+    {
+      free(shard);
+      shard = expected;
+    }
+  }
+
+  return shard;
+}
+
+encoder_position_t encoder_registry_update_batch_tt(
+    encoder_registry_shard* shard, size_t i, uint64_t const* samples,
+    uint64_t* actions, size_t words,
+    encoder_byte_t ENCODER_CONST_MEMORY table[][4])
+{
+  encoder_position_t const delta = encoder_batch_update_tt(
+      &shard->states[i], samples, actions, words, table);
+
+  encoder_internal_registry_add(&shard->positions[i], delta);
+
+  return delta;
+}
+
+encoder_position_t encoder_registry_position(encoder_registry const* r,
+                                             size_t encoder)
+{
+  size_t s = encoder * r->count / r->encoders;
+  encoder_registry_shard const* shard;
+
+  /* the integer division may be off by one in either direction */
+  while (r->encoders * (s + 1) / r->count <= encoder)
+  {
+    ++s;
+  }
+
+  while (r->encoders * s / r->count > encoder)
+  {
+    --s;
+  }
+
+  shard = atomic_load_explicit(&r->shards[s], memory_order_acquire);
+
+  return shard ? __atomic_load_n(&shard->positions[encoder - shard->first],
+                                 __ATOMIC_RELAXED)
+               : 0;
+}
+
+encoder_position_t encoder_registry_read(encoder_registry const* r,
+                                         encoder_position_t* positions)
+{
+  encoder_position_t sum = 0;
+
+  for (size_t s = 0; s < r->count; ++s)
+  {
+    encoder_registry_shard const* shard =
+        atomic_load_explicit(&r->shards[s], memory_order_acquire);
+    size_t const count =
+        r->encoders * (s + 1) / r->count - r->encoders * s / r->count;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      encoder_position_t const p =
+          shard ? __atomic_load_n(&shard->positions[i], __ATOMIC_RELAXED) : 0;
+
+      if (positions)
+      {
+        *positions++ = p;
+      }
+
+      sum += p;
+    }
+  }
+
+  return sum;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/ring_decoder.h>
+
+static unsigned encoder_ring_decode_span(encoder_ring const* r,
+                                         encoder_ring_encoder* e,
+                                         encoder_ring_sample_t const* sample,
+                                         encoder_ring_sample_t const* end)
+{
+  encoder_fast_byte_t const pin_a = e->pin_a;
+  encoder_fast_byte_t const pin_b = e->pin_b;
+  encoder_fast_byte_t state = e->state;
+  encoder_position_t position = e->position;
+  unsigned actions = 0;
+
+  /* keep everything in registers while running through the samples */
+  for (; sample != end; ++sample)
+  {
+    encoder_fast_byte_t const terminal =
+        ((*sample >> pin_a) & 1) | ((*sample >> pin_b) & 1) << 1;
+    encoder_fast_byte_t const entry = r->table[state][terminal];
+    encoder_fast_byte_t const action =
+        entry >> ENCODER_INTERNAL_ACTION_SHIFT_TT;
+
+    state = entry & ENCODER_INTERNAL_STATE_MASK_TT;
+
+    if (action)
+    {
+      position += action == ENCODER_ACTION_TURN_CW ? 1 : -1;
+      ++actions;
+    }
+  }
+
+  e->state = state;
+  e->position = position;
+
+  return actions;
+}
+
+unsigned encoder_ring_decode(encoder_ring* r, size_t end)
+{
+  encoder_ring_sample_t const* const begin = r->buffer + r->next;
+  unsigned actions = 0;
+  encoder_fast_byte_t i;
+
+  if (end == r->size)
+  {
+    end = 0;
+  }
+
+  if (end == r->next)
+  {
+    return 0;
+  }
+
+  for (i = 0; i < r->count; ++i)
+  {
+    encoder_ring_encoder* e = &r->encoders[i];
+
+    if (end > r->next)
+    {
+      actions += encoder_ring_decode_span(r, e, begin, r->buffer + end);
+    }
+    else
+    {
+      /* wrap around */
+      actions += encoder_ring_decode_span(r, e, begin, r->buffer + r->size);
+      actions += encoder_ring_decode_span(r, e, r->buffer, r->buffer + end);
+    }
+  }
+
+  r->next = end;
+
+  return actions;
+}
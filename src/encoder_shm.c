@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <rotaryencoder/shm.h>
+
+#define ENCODER_INTERNAL_SHM_MAGIC UINT64_C(0x524f54454e434d31)
+
+/*
+ * Each line holds a sequence number, which is odd while the writer updates
+ * the line, and the positions. Lines are aligned to 64 bytes, so they
+ * never share a cache line.
+ */
+struct encoder_internal_shm_line
+{
+  _Alignas(64) _Atomic uint64_t sequence;
+  _Atomic int64_t position[ENCODER_SHM_LINE_POSITIONS];
+};
+
+struct encoder_internal_shm_header
+{
+  _Alignas(64) uint64_t magic;
+  uint64_t count;
+};
+
+struct encoder_shm
+{
+  struct encoder_internal_shm_header* header;
+  struct encoder_internal_shm_line* lines;
+  size_t size;
+  size_t count;
+};
+
+static size_t encoder_internal_shm_size(size_t count)
+{
+  size_t const lines =
+      (count + ENCODER_SHM_LINE_POSITIONS - 1) / ENCODER_SHM_LINE_POSITIONS;
+
+  return sizeof(struct encoder_internal_shm_header) +
+         lines * sizeof(struct encoder_internal_shm_line);
+}
+
+static encoder_shm* encoder_internal_shm_map(int fd, size_t size, int prot)
+{
+  encoder_shm* shm = malloc(sizeof(*shm));
+  void* p;
+
+  if (!shm)
+  {
+    return NULL;
+  }
+
+  p = mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+
+  if (p == MAP_FAILED)
+  {
+    free(shm);
+    return NULL;
+  }
+
+  shm->header = p;
+  shm->lines = (struct encoder_internal_shm_line*)(
+      (char*)p + sizeof(struct encoder_internal_shm_header));
+  shm->size = size;
+
+  return shm;
+}
+
+encoder_shm* encoder_shm_create(char const* name, size_t count)
+{
+  size_t const size = encoder_internal_shm_size(count);
+  encoder_shm* shm;
+  int fd;
+
+  shm_unlink(name);
+
+  fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+
+  if (fd < 0)
+  {
+    return NULL;
+  }
+
+  /* the new object is zero-filled, which makes all lines consistent */
+  if (ftruncate(fd, (off_t)size) != 0)
+  {
+    int const err = errno;
+    close(fd);
+    shm_unlink(name);
+    errno = err;
+    return NULL;
+  }
+
+  shm = encoder_internal_shm_map(fd, size, PROT_READ | PROT_WRITE);
+  close(fd);
+
+  if (!shm)
+  {
+    int const err = errno;
+    shm_unlink(name);
+    errno = err;
+    return NULL;
+  }
+
+  shm->count = count;
+  shm->header->count = count;
+
+  /* readers check the magic last, so it must become visible last */
+  atomic_thread_fence(memory_order_release);
+  shm->header->magic = ENCODER_INTERNAL_SHM_MAGIC;
+
+  return shm;
+}
+
+encoder_shm* encoder_shm_open(char const* name)
+{
+  struct stat st;
+  encoder_shm* shm;
+  int fd = shm_open(name, O_RDONLY, 0);
+
+  if (fd < 0)
+  {
+    return NULL;
+  }
+
+  if (fstat(fd, &st) != 0 ||
+      (size_t)st.st_size < sizeof(struct encoder_internal_shm_header))
+  {
+    close(fd);
+    errno = EINVAL;
+    return NULL;
+  }
+
+  shm = encoder_internal_shm_map(fd, (size_t)st.st_size, PROT_READ);
+  close(fd);
+
+  if (!shm)
+  {
+    return NULL;
+  }
+
+  if (shm->header->magic != ENCODER_INTERNAL_SHM_MAGIC ||
+      encoder_internal_shm_size(shm->header->count) > shm->size)
+  {
+    encoder_shm_close(shm);
+    errno = EINVAL;
+    return NULL;
+  }
+
+  atomic_thread_fence(memory_order_acquire);
+  shm->count = shm->header->count;
+
+  return shm;
+}
+
+void encoder_shm_close(encoder_shm* shm)
+{
+  if (shm)
+  {
+    munmap(shm->header, shm->size);
+    free(shm);
+  }
+}
+
+int encoder_shm_unlink(char const* name) { return shm_unlink(name); }
+
+size_t encoder_shm_count(encoder_shm const* shm) { return shm->count; }
+
+void encoder_shm_publish(encoder_shm* shm, size_t first,
+                         encoder_position_t const* positions, size_t n)
+{
+  size_t const end = first + n;
+
+  while (first < end)
+  {
+    struct encoder_internal_shm_line* line =
+        &shm->lines[first / ENCODER_SHM_LINE_POSITIONS];
+    size_t k = first % ENCODER_SHM_LINE_POSITIONS;
+    uint64_t const seq =
+        atomic_load_explicit(&line->sequence, memory_order_relaxed);
+
+    atomic_store_explicit(&line->sequence, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (; k < ENCODER_SHM_LINE_POSITIONS && first < end; ++k, ++first)
+    {
+      atomic_store_explicit(&line->position[k], *positions++,
+                            memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&line->sequence, seq + 2, memory_order_release);
+  }
+}
+
+size_t encoder_shm_read(encoder_shm const* shm, size_t first,
+                        encoder_position_t* positions, size_t n)
+{
+  size_t const end = first + n;
+  size_t retries = 0;
+
+  while (first < end)
+  {
+    struct encoder_internal_shm_line* line =
+        &shm->lines[first / ENCODER_SHM_LINE_POSITIONS];
+    size_t const k0 = first % ENCODER_SHM_LINE_POSITIONS;
+    size_t const count = ENCODER_SHM_LINE_POSITIONS - k0 < end - first
+                             ? ENCODER_SHM_LINE_POSITIONS - k0
+                             : end - first;
+
+    for (;;)
+    {
+      uint64_t const seq =
+          atomic_load_explicit(&line->sequence, memory_order_acquire);
+
+      if ((seq & 1) == 0)
+      {
+        for (size_t k = 0; k < count; ++k)
+        {
+          positions[k] = (encoder_position_t)atomic_load_explicit(
+              &line->position[k0 + k], memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&line->sequence, memory_order_relaxed) ==
+            seq)
+        {
+          break;
+        }
+      }
+
+      ++retries;
+    }
+
+    positions += count;
+    first += count;
+  }
+
+  return retries;
+}
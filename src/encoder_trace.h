@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SRC_ENCODER_TRACE_H
+#define SRC_ENCODER_TRACE_H
+
+/*
+ * Static tracepoints of the `rotaryencoder` provider. They are only built
+ * with ROTARYENCODER_ENABLE_USDT, otherwise all macros expand to nothing.
+ * Probes whose arguments are costly to compute are guarded by a
+ * semaphore, which the tracer increments while it is attached, so they
+ * cost a load and a predicted branch when no one is listening.
+ *
+ * batch_entry(state, samples, words, table)
+ * batch_exit(state, delta)
+ *   Around each encoder_batch_update_tt() call.
+ *
+ * illegal(samples, index, mask)
+ *   For each sample word with samples in which both terminals changed,
+ *   with a bit set in `mask` at the even position of each such sample.
+ *
+ * actions(samples, index, actions)
+ *   For each sample word that caused actions, in the packed layout of
+ *   encoder_batch_update_tt().
+ */
+
+#ifdef ROTARYENCODER_HAVE_USDT
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/* defined in batch_update.c */
+extern unsigned short rotaryencoder_batch_entry_semaphore;
+extern unsigned short rotaryencoder_batch_exit_semaphore;
+extern unsigned short rotaryencoder_illegal_semaphore;
+extern unsigned short rotaryencoder_actions_semaphore;
+
+#define ENCODER_TRACE_ENABLED(name)                                            \
+  __builtin_expect(rotaryencoder_##name##_semaphore != 0, 0)
+
+#define ENCODER_TRACE2(name, a1, a2) DTRACE_PROBE2(rotaryencoder, name, a1, a2)
+#define ENCODER_TRACE3(name, a1, a2, a3)                                       \
+  DTRACE_PROBE3(rotaryencoder, name, a1, a2, a3)
+#define ENCODER_TRACE4(name, a1, a2, a3, a4)                                   \
+  DTRACE_PROBE4(rotaryencoder, name, a1, a2, a3, a4)
+
+#else
+
+#define ENCODER_TRACE_ENABLED(name) 0
+#define ENCODER_TRACE2(name, a1, a2) ((void)0)
+#define ENCODER_TRACE3(name, a1, a2, a3) ((void)0)
+#define ENCODER_TRACE4(name, a1, a2, a3, a4) ((void)0)
+
+#endif
+
+#endif
@@ -21,6 +21,7 @@
  */
 
 #include <rotaryencoder/simple_encoder.h>
+#include <rotaryencoder/fused.h>
 
 enum
 {
@@ -49,3 +50,22 @@ ENCODER_CONST_MEMORY encoder_byte_t encoder_simple_full_step_table[4][4] = {
     /* ES_P11 11 */ {ES_E00, ES_CCF, ES_P10, ES_P11}
     /* clang-format on */
 };
+
+ENCODER_CONST_MEMORY encoder_byte_t encoder_simple_full_step_edges_table[4] = {
+    /* clang-format off */
+    /* ES_P00 */ ENCODER_TERMINAL_A,
+    /* ES_P01 */ ENCODER_TERMINAL_B,
+    /* ES_P10 */ ENCODER_TERMINAL_A,
+    /* ES_P11 */ ENCODER_TERMINAL_B
+    /* clang-format on */
+};
+
+ENCODER_CONST_MEMORY encoder_fused_t
+    encoder_simple_full_step_fused_table[4][4] = {
+        /* clang-format off */
+        ENCODER_INTERNAL_FUSED_ROW(ES_P00, ES_P00, ES_P01, ES_P10, ES_E11),
+        ENCODER_INTERNAL_FUSED_ROW(ES_P01, ES_P00, ES_P01, ES_E10, ES_CWF),
+        ENCODER_INTERNAL_FUSED_ROW(ES_P10, ES_P00, ES_E01, ES_P10, ES_P11),
+        ENCODER_INTERNAL_FUSED_ROW(ES_P11, ES_E00, ES_CCF, ES_P10, ES_P11)
+        /* clang-format on */
+};
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rotaryencoder/simple_encoder.h>
+
+enum encoder_action
+encoder_simple_quarter_step_update(encoder_state* s,
+                                   encoder_fast_byte_t terminal)
+{
+  encoder_fast_byte_t const state = *s;
+  encoder_fast_byte_t const sxt = state ^ terminal;
+
+  *s = terminal;
+
+  if (sxt == 0 || sxt == 3)
+  {
+    return ENCODER_ACTION_NONE;
+  }
+
+  /* clockwise flips A if A == B, and B if A != B */
+  return sxt == 1 + ((state ^ (state >> 1)) & 1) ? ENCODER_ACTION_TURN_CW
+                                                 : ENCODER_ACTION_TURN_CCW;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <limits.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/acceleration.h>
+
+static unsigned short ENCODER_CONST_MEMORY curve_table[] = {
+    8 * ENCODER_ACCEL_ONE, 4 * ENCODER_ACCEL_ONE, 2 * ENCODER_ACCEL_ONE,
+    ENCODER_ACCEL_ONE / 2};
+
+static encoder_accel_curve const curve = {curve_table, 4, 4};
+
+typedef int (*update_func)(encoder_accel*, encoder_accel_curve const*,
+                           enum encoder_action, unsigned);
+
+/*
+ * Turn the encoder `steps` times with the given interval, returning the
+ * sum of the increments.
+ */
+static int turn(update_func update, encoder_accel* a, unsigned* now,
+                enum encoder_action action, int steps, unsigned interval)
+{
+  int sum = 0;
+
+  for (int i = 0; i < steps; ++i)
+  {
+    *now += interval;
+    sum += update(a, &curve, action, *now);
+  }
+
+  return sum;
+}
+
+TEST constant(update_func update)
+{
+  encoder_accel a;
+  unsigned now = 1000;
+
+  encoder_accel_init(&a);
+
+  /* the first step after a change of direction is always slow */
+  ASSERT_EQ(1, update(&a, &curve, ENCODER_ACTION_TURN_CW, now));
+
+  /* slow turns use the last entry, here 0.5x */
+  ASSERT_EQ(50, turn(update, &a, &now, ENCODER_ACTION_TURN_CW, 100, 1000));
+  ASSERT_EQ(50, turn(update, &a, &now, ENCODER_ACTION_TURN_CW, 100, 48));
+
+  /* turning fast for a while reaches the full multiplier */
+  turn(update, &a, &now, ENCODER_ACTION_TURN_CW, 20, 0);
+  ASSERT_EQ(800, turn(update, &a, &now, ENCODER_ACTION_TURN_CW, 100, 0));
+  turn(update, &a, &now, ENCODER_ACTION_TURN_CW, 20, 16);
+  ASSERT_EQ(400, turn(update, &a, &now, ENCODER_ACTION_TURN_CW, 100, 16));
+
+  /* no action, no change */
+  ASSERT_EQ(0, update(&a, &curve, ENCODER_ACTION_NONE, now + 1000));
+  ASSERT_EQ(4, update(&a, &curve, ENCODER_ACTION_TURN_CW, now += 16));
+
+  /* reversing restarts slowly */
+  ASSERT_EQ(-1, update(&a, &curve, ENCODER_ACTION_TURN_CCW, now += 16));
+  ASSERT_EQ(-2, update(&a, &curve, ENCODER_ACTION_TURN_CCW, now += 16));
+  turn(update, &a, &now, ENCODER_ACTION_TURN_CCW, 20, 16);
+  ASSERT_EQ(-400, turn(update, &a, &now, ENCODER_ACTION_TURN_CCW, 100, 16));
+
+  PASS();
+}
+
+TEST wraparound(update_func update)
+{
+  encoder_accel a;
+  unsigned now = UINT_MAX - 1000;
+
+  encoder_accel_init(&a);
+
+  turn(update, &a, &now, ENCODER_ACTION_TURN_CW, 20, 16);
+  ASSERT_EQ(400, turn(update, &a, &now, ENCODER_ACTION_TURN_CW, 100, 16));
+
+  PASS();
+}
+
+TEST nearest(void)
+{
+  encoder_accel a;
+  unsigned now = 0;
+
+  encoder_accel_init(&a);
+  encoder_accel_update(&a, &curve, ENCODER_ACTION_TURN_CW, now);
+
+  turn(encoder_accel_update, &a, &now, ENCODER_ACTION_TURN_CW, 20, 24);
+  ASSERT_EQ(400, turn(encoder_accel_update, &a, &now, ENCODER_ACTION_TURN_CW,
+                      100, 24));
+
+  PASS();
+}
+
+TEST linear(void)
+{
+  encoder_accel a;
+  unsigned now = 0;
+
+  encoder_accel_init(&a);
+  encoder_accel_update_linear(&a, &curve, ENCODER_ACTION_TURN_CW, now);
+
+  /* halfway between 4x and 2x */
+  turn(encoder_accel_update_linear, &a, &now, ENCODER_ACTION_TURN_CW, 20, 24);
+  ASSERT_EQ(300, turn(encoder_accel_update_linear, &a, &now,
+                      ENCODER_ACTION_TURN_CW, 100, 24));
+
+  /* a quarter of the way from 2x to 0.5x */
+  turn(encoder_accel_update_linear, &a, &now, ENCODER_ACTION_TURN_CW, 20, 36);
+  ASSERT_EQ(1300, turn(encoder_accel_update_linear, &a, &now,
+                       ENCODER_ACTION_TURN_CW, 800, 36));
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TESTp(constant, encoder_accel_update);
+  RUN_TESTp(constant, encoder_accel_update_linear);
+  RUN_TESTp(wraparound, encoder_accel_update);
+  RUN_TESTp(wraparound, encoder_accel_update_linear);
+  RUN_TEST(nearest);
+  RUN_TEST(linear);
+
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/analog.h>
+
+enum
+{
+  WORDS = 32,
+  FRAMES = 32 * WORDS,
+  MAX_STRIDE = 3
+};
+
+typedef encoder_byte_t ENCODER_CONST_MEMORY (*table_type)[4];
+
+struct thresholds
+{
+  uint16_t low_a, high_a, low_b, high_b;
+};
+
+static uint16_t samples[FRAMES * MAX_STRIDE];
+
+/* 12-bit triangle wave with a period of 4096 */
+static int triangle(unsigned phase)
+{
+  phase %= 4096;
+  return phase < 2048 ? (int)phase * 2 : (4095 - (int)phase) * 2;
+}
+
+static uint16_t clamp(int x) { return x < 0 ? 0 : x > 4095 ? 4095 : x; }
+
+/*
+ * Quadrature signals of a randomly turning encoder, with noise. Samples
+ * beyond the A/B channels of each frame are filled with garbage.
+ */
+static void make_analog(size_t stride, int noise)
+{
+  unsigned phase = random() % 4096;
+
+  for (size_t i = 0; i < FRAMES; ++i)
+  {
+    phase += random() % 65 - 24;
+
+    samples[i * stride] = clamp(triangle(phase) + random() % (2 * noise + 1) -
+                                noise);
+    samples[i * stride + 1] = clamp(triangle(phase + 1024) +
+                                    random() % (2 * noise + 1) - noise);
+
+    for (size_t k = 2; k < stride; ++k)
+    {
+      samples[i * stride + k] = random();
+    }
+  }
+}
+
+static void make_random(size_t stride)
+{
+  for (size_t i = 0; i < FRAMES * stride; ++i)
+  {
+    samples[i] = random() % 4 == 0 ? (random() % 2 ? 0 : 0xFFFF) : random();
+  }
+}
+
+static encoder_fast_byte_t reference(encoder_fast_byte_t terminal,
+                                     struct thresholds const* t,
+                                     uint16_t const* frame)
+{
+  if (frame[0] >= t->high_a)
+  {
+    terminal |= 1;
+  }
+  else if (frame[0] < t->low_a)
+  {
+    terminal &= ~1;
+  }
+
+  if (frame[1] >= t->high_b)
+  {
+    terminal |= 2;
+  }
+  else if (frame[1] < t->low_b)
+  {
+    terminal &= ~2;
+  }
+
+  return terminal;
+}
+
+TEST pack(size_t stride, struct thresholds t)
+{
+  uint64_t terminals[WORDS];
+  encoder_analog a;
+  encoder_fast_byte_t term = random() % 4;
+
+  encoder_analog_init(&a, t.low_a, t.high_a, t.low_b, t.high_b, term);
+
+  /* convert in two parts to check the levels are kept */
+  encoder_analog_pack(&a, samples, stride, terminals, WORDS / 2);
+  encoder_analog_pack(&a, &samples[FRAMES / 2 * stride], stride,
+                      &terminals[WORDS / 2], WORDS / 2);
+
+  for (size_t i = 0; i < FRAMES; ++i)
+  {
+    term = reference(term, &t, &samples[i * stride]);
+    ASSERT_EQ_FMT((int)term, (int)((terminals[i / 32] >> 2 * (i % 32)) & 3),
+                  "%d");
+  }
+
+  ASSERT_EQ_FMT((int)term, (int)a.terminal, "%d");
+
+  PASS();
+}
+
+TEST decode(size_t stride, table_type table)
+{
+  static struct thresholds const t = {1800, 2300, 1900, 2200};
+  uint64_t actions[WORDS];
+  encoder_analog a;
+  encoder_state es, es_ref;
+  encoder_position_t delta;
+  encoder_fast_byte_t term = 0x3;
+  int steps = 0;
+
+  encoder_analog_init(&a, t.low_a, t.high_a, t.low_b, t.high_b, term);
+  es = es_ref = 0x3;
+
+  delta = encoder_analog_update_batch_tt(&a, &es, samples, stride, actions,
+                                         WORDS, table);
+
+  for (size_t i = 0; i < FRAMES; ++i)
+  {
+    enum encoder_action action;
+
+    term = reference(term, &t, &samples[i * stride]);
+    action = encoder_internal_update_tt(&es_ref, term, table);
+
+    ASSERT_EQ_FMT((int)action, (int)((actions[i / 32] >> 2 * (i % 32)) & 3),
+                  "%d");
+
+    delta -= action == ENCODER_ACTION_TURN_CW    ? 1
+             : action == ENCODER_ACTION_TURN_CCW ? -1
+                                                 : 0;
+    steps += action != ENCODER_ACTION_NONE;
+  }
+
+  ASSERT_EQ_FMT(0L, delta, "%ld");
+  ASSERT_EQ_FMT((int)es_ref, (int)es, "%d");
+  ASSERT(steps > 0);
+
+  PASS();
+}
+
+TEST interpolate(size_t stride, int offset, int hysteresis)
+{
+  static encoder_position_t positions[FRAMES];
+  encoder_interpolator ip, ref;
+  size_t const split = random() % FRAMES;
+
+  encoder_interpolator_init(&ip, offset, offset, hysteresis, samples[0],
+                            samples[1]);
+  ref = ip;
+
+  /* split at an arbitrary frame to check the state is kept */
+  encoder_interpolator_update_batch(&ip, samples, stride, positions, split);
+  encoder_interpolator_update_batch(&ip, &samples[split * stride], stride,
+                                    &positions[split], FRAMES - split);
+
+  for (size_t i = 0; i < FRAMES; ++i)
+  {
+    encoder_position_t const pos = encoder_interpolator_update(
+        &ref, samples[i * stride], samples[i * stride + 1]);
+    ASSERT_EQ_FMT(pos, positions[i], "%ld");
+  }
+
+  ASSERT_EQ_FMT(ref.count, ip.count, "%ld");
+  ASSERT_EQ_FMT((int)ref.terminal, (int)ip.terminal, "%d");
+  ASSERT_EQ_FMT((int)ref.state, (int)ip.state, "%d");
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  static struct thresholds const edge_cases[] = {
+      {1800, 2300, 1900, 2200}, {2048, 2048, 2048, 2048},
+      {0, 0, 0, 0},             {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF},
+      {0, 0xFFFF, 1, 0xFFFE},   {0x7FFF, 0x8000, 0x8000, 0x8001},
+  };
+
+  GREATEST_MAIN_BEGIN();
+
+  srandom(42);
+
+  for (size_t stride = 2; stride <= MAX_STRIDE; ++stride)
+  {
+    for (int k = 0; k < 10; ++k)
+    {
+      make_analog(stride, 200);
+      RUN_TESTp(pack, stride, edge_cases[0]);
+
+      make_analog(stride, 50);
+      RUN_TESTp(decode, stride, encoder_debounced_half_step_table);
+      RUN_TESTp(decode, stride, encoder_simple_quarter_step_table);
+      RUN_TESTp(interpolate, stride, 2048, 100);
+    }
+
+    for (size_t i = 0; i < sizeof(edge_cases) / sizeof(edge_cases[0]); ++i)
+    {
+      make_random(stride);
+      RUN_TESTp(pack, stride, edge_cases[i]);
+    }
+
+    make_random(stride);
+    RUN_TESTp(interpolate, stride, 32768, 0);
+    RUN_TESTp(interpolate, stride, 32768, 10000);
+  }
+
+  GREATEST_MAIN_END();
+}
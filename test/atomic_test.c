@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/atomic.h>
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/simple_encoder.h>
+
+typedef encoder_byte_t ENCODER_CONST_MEMORY (*table_type)[4];
+
+enum
+{
+  THREADS = 4,
+  UPDATES = 200000
+};
+
+static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+
+#define NEXT(s) {s, s, s, s}
+
+/*
+ * Moves to the next of 16 states on every update regardless of the
+ * terminals, and turns clockwise when wrapping around, so the final state
+ * and position tell exactly how many updates have been applied.
+ */
+static ENCODER_CONST_MEMORY encoder_byte_t counting_table[16][4] = {
+    /* clang-format off */
+    NEXT(1),  NEXT(2),  NEXT(3),  NEXT(4),
+    NEXT(5),  NEXT(6),  NEXT(7),  NEXT(8),
+    NEXT(9),  NEXT(10), NEXT(11), NEXT(12),
+    NEXT(13), NEXT(14), NEXT(15),
+    NEXT(0 | ENCODER_ACTION_TURN_CW << ENCODER_INTERNAL_ACTION_SHIFT_TT)
+    /* clang-format on */
+};
+
+TEST sequential(table_type table, encoder_byte_t states)
+{
+  unsigned seed = 42;
+
+  for (encoder_byte_t first = 0; first < states; ++first)
+  {
+    encoder_state s = first, s_atomic = first;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+      encoder_fast_byte_t const terminal = rand_r(&seed) % 4;
+
+      ASSERT_EQ(encoder_internal_update_tt(&s, terminal, table),
+                encoder_atomic_update_tt(&s_atomic, terminal, table));
+      ASSERT_EQ(s, s_atomic);
+    }
+  }
+
+  PASS();
+}
+
+struct shared
+{
+  table_type table;
+  encoder_state state;
+  encoder_position_t position;
+};
+
+static void* work(void* arg)
+{
+  struct shared* sh = arg;
+  unsigned seed = (unsigned)(uintptr_t)&seed;
+
+  for (int i = 0; i < UPDATES; ++i)
+  {
+    encoder_atomic_update_position_tt(&sh->state, &sh->position,
+                                      gray[rand_r(&seed) % 4], sh->table);
+  }
+
+  return NULL;
+}
+
+static int stress(struct shared* sh)
+{
+  pthread_t thread[THREADS];
+
+  for (int t = 0; t < THREADS; ++t)
+  {
+    if (pthread_create(&thread[t], NULL, work, sh) != 0)
+    {
+      return -1;
+    }
+  }
+
+  for (int t = 0; t < THREADS; ++t)
+  {
+    pthread_join(thread[t], NULL);
+  }
+
+  return 0;
+}
+
+TEST counting(void)
+{
+  struct shared sh = {counting_table, 0, 0};
+  long const total = (long)THREADS * UPDATES;
+
+  ASSERT_EQ(0, stress(&sh));
+
+  /* no update has been lost or applied twice */
+  ASSERT_EQ_FMT(total / 16, sh.position, "%ld");
+  ASSERT_EQ((encoder_state)(total % 16), sh.state);
+
+  PASS();
+}
+
+TEST quarter_step(void)
+{
+  static int const index[4] = {2, 3, 1, 0};
+  struct shared sh = {encoder_simple_quarter_step_table, 0, 0};
+
+  encoder_simple_quarter_step_init(&sh.state, gray[0]);
+  ASSERT_EQ(0, stress(&sh));
+
+  /*
+   * The updates have been applied in some order, each to the state left by
+   * the previous one. Each update moves by one step and generates an action,
+   * or moves by zero or two steps without one, so the parity of the position
+   * must agree with the final state.
+   */
+  ASSERT_EQ(0, (sh.position - index[sh.state]) % 2);
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TESTp(sequential, encoder_simple_full_step_table, 4);
+  RUN_TESTp(sequential, encoder_simple_half_step_table, 4);
+  RUN_TESTp(sequential, encoder_simple_quarter_step_table, 4);
+  RUN_TESTp(sequential, encoder_debounced_full_step_table, 7);
+  RUN_TESTp(sequential, encoder_debounced_half_step_table, 6);
+  RUN_TESTp(sequential, encoder_debounced_full_step_recovering_table, 13);
+  RUN_TESTp(sequential, encoder_debounced_half_step_recovering_table, 10);
+  RUN_TESTp(sequential, counting_table, 16);
+
+  RUN_TEST(counting);
+  RUN_TEST(quarter_step);
+
+  GREATEST_MAIN_END();
+}
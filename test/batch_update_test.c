@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/batch.h>
+
+typedef void (*init_func)(encoder_state*, encoder_fast_byte_t);
+
+typedef encoder_byte_t ENCODER_CONST_MEMORY (*table_type)[4];
+
+static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+
+/*
+ * Random walk along the gray code sequence, holding each position for up
+ * to `hold` samples and with the occasional random (noise) sample.
+ */
+static void make_samples(uint64_t* samples, size_t words, int hold)
+{
+  unsigned pos = random() % 4;
+  int left = 0;
+
+  for (size_t i = 0; i < words; ++i)
+  {
+    uint64_t w = 0;
+
+    for (unsigned k = 0; k < 64; k += 2)
+    {
+      uint64_t term;
+
+      if (left-- <= 0)
+      {
+        pos += random() % 3 - 1;
+        left = random() % hold;
+      }
+
+      term = random() % 16 == 0 ? (uint64_t)(random() % 4) : gray[pos % 4];
+      w |= term << k;
+    }
+
+    samples[i] = w;
+  }
+}
+
+TEST compare(enum encoder_batch_isa isa, init_func init, table_type table,
+             int hold)
+{
+  enum
+  {
+    WORDS = 64
+  };
+
+  ASSERT_EQ(0, encoder_batch_select_isa(isa));
+  ASSERT_EQ(isa, encoder_batch_selected_isa());
+
+  for (int i = 0; i < 50; ++i)
+  {
+    uint64_t samples[WORDS];
+    uint64_t actions[WORDS];
+    encoder_state es, es_batch;
+    encoder_position_t delta = 0;
+    encoder_fast_byte_t term = random() % 4;
+
+    init(&es, term);
+    init(&es_batch, term);
+
+    make_samples(samples, WORDS, hold);
+
+    ASSERT_EQ(0, encoder_batch_update_tt(&es_batch, samples, NULL, 0, table));
+
+    for (size_t w = 0; w < WORDS; w += 16)
+    {
+      delta += encoder_batch_update_tt(&es_batch, &samples[w], &actions[w], 16,
+                                       table);
+    }
+
+    for (size_t w = 0; w < WORDS; ++w)
+    {
+      for (unsigned k = 0; k < 64; k += 2)
+      {
+        enum encoder_action action =
+            encoder_internal_update_tt(&es, (samples[w] >> k) & 0x3, table);
+
+        ASSERT_EQ_FMT((int)action, (int)((actions[w] >> k) & 0x3), "%d");
+
+        delta -= action == ENCODER_ACTION_TURN_CW    ? 1
+                 : action == ENCODER_ACTION_TURN_CCW ? -1
+                                                     : 0;
+      }
+    }
+
+    ASSERT_EQ_FMT((int)es, (int)es_batch, "%d");
+    ASSERT_EQ_FMT(0L, delta, "%ld");
+  }
+
+  PASS();
+}
+
+TEST flavours(void)
+{
+  uint64_t samples[8];
+  encoder_state es, es_tt;
+  encoder_position_t delta = 0;
+
+  make_samples(samples, 8, 4);
+
+  encoder_debounced_full_step_init(&es, 0x3);
+  encoder_debounced_full_step_init(&es_tt, 0x3);
+
+  for (size_t w = 0; w < 8; ++w)
+  {
+    for (unsigned k = 0; k < 64; k += 2)
+    {
+      switch (encoder_debounced_full_step_update_tt(&es_tt,
+                                                    (samples[w] >> k) & 0x3))
+      {
+      case ENCODER_ACTION_TURN_CW:
+        ++delta;
+        break;
+      case ENCODER_ACTION_TURN_CCW:
+        --delta;
+        break;
+      case ENCODER_ACTION_NONE:
+        break;
+      }
+    }
+  }
+
+  ASSERT_EQ_FMT(delta,
+                encoder_debounced_full_step_update_batch(&es, samples, NULL, 8),
+                "%ld");
+  ASSERT_EQ_FMT((int)es_tt, (int)es, "%d");
+
+  PASS();
+}
+
+TEST dispatch(void)
+{
+  enum encoder_batch_isa const isa = encoder_batch_selected_isa();
+
+  ASSERT(isa != ENCODER_BATCH_ISA_AUTO);
+  ASSERT(encoder_batch_isa_supported(ENCODER_BATCH_ISA_AUTO));
+  ASSERT(encoder_batch_isa_supported(ENCODER_BATCH_ISA_GENERIC));
+  ASSERT(encoder_batch_isa_name(isa) != NULL);
+
+  ASSERT_EQ(0, encoder_batch_select_isa(ENCODER_BATCH_ISA_GENERIC));
+  ASSERT_EQ(ENCODER_BATCH_ISA_GENERIC, encoder_batch_selected_isa());
+
+  /* unknown implementations must be rejected without changing anything */
+  ASSERT_EQ(-1, encoder_batch_select_isa((enum encoder_batch_isa)42));
+  ASSERT_EQ(ENCODER_BATCH_ISA_GENERIC, encoder_batch_selected_isa());
+  ASSERT_EQ(NULL, encoder_batch_isa_name((enum encoder_batch_isa)42));
+
+  ASSERT_EQ(0, encoder_batch_select_isa(ENCODER_BATCH_ISA_AUTO));
+  ASSERT_EQ(isa, encoder_batch_selected_isa());
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  static struct
+  {
+    init_func init;
+    table_type table;
+  } const flavours_list[] = {
+      {encoder_simple_full_step_init, encoder_simple_full_step_table},
+      {encoder_simple_half_step_init, encoder_simple_half_step_table},
+      {encoder_simple_quarter_step_init, encoder_simple_quarter_step_table},
+      {encoder_debounced_full_step_init, encoder_debounced_full_step_table},
+      {encoder_debounced_half_step_init, encoder_debounced_half_step_table},
+      {encoder_debounced_full_step_recovering_init,
+       encoder_debounced_full_step_recovering_table},
+      {encoder_debounced_half_step_recovering_init,
+       encoder_debounced_half_step_recovering_table},
+  };
+
+  static enum encoder_batch_isa const isas[] = {
+      ENCODER_BATCH_ISA_GENERIC,
+      ENCODER_BATCH_ISA_BMI2,
+  };
+
+  GREATEST_MAIN_BEGIN();
+
+  srandom(42);
+
+  RUN_TEST(dispatch);
+
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i)
+  {
+    if (!encoder_batch_isa_supported(isas[i]))
+    {
+      continue;
+    }
+
+    for (size_t f = 0; f < sizeof(flavours_list) / sizeof(flavours_list[0]);
+         ++f)
+    {
+      RUN_TESTp(compare, isas[i], flavours_list[f].init,
+                flavours_list[f].table, 1);
+      RUN_TESTp(compare, isas[i], flavours_list[f].init,
+                flavours_list[f].table, 20);
+    }
+  }
+
+  encoder_batch_select_isa(ENCODER_BATCH_ISA_AUTO);
+
+  RUN_TEST(flavours);
+
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/buttons.h>
+
+enum
+{
+  BUTTONS = 64,
+  SCANS = 20000
+};
+
+enum
+{
+  PRESSED = 1,
+  RELEASED = 2,
+  LONG_PRESSED = 4
+};
+
+/* straightforward per-button debouncer */
+struct reference
+{
+  unsigned state;
+  unsigned differing;
+  unsigned ticks;
+  unsigned reported;
+};
+
+static void reference_init(struct reference* r, unsigned state)
+{
+  r->state = state;
+  r->differing = 0;
+  r->ticks = 0;
+  r->reported = state;
+}
+
+static unsigned reference_update(struct reference* r, unsigned raw,
+                                 unsigned long_ticks)
+{
+  unsigned events = 0;
+
+  if (raw != r->state && ++r->differing == 4)
+  {
+    r->state = raw;
+    r->ticks = 0;
+    r->reported = 0;
+    events |= raw ? PRESSED : RELEASED;
+  }
+
+  if (raw == r->state)
+  {
+    r->differing = 0;
+  }
+
+  if (r->state && !r->reported && ++r->ticks == long_ticks)
+  {
+    r->reported = 1;
+    events |= LONG_PRESSED;
+  }
+
+  return events;
+}
+
+/*
+ * Buttons that are pressed and released at random, bouncing for a few
+ * scans after each change and with the occasional glitch.
+ */
+static uint64_t scan(uint64_t* level, unsigned* bounce)
+{
+  uint64_t raw = 0;
+
+  for (unsigned i = 0; i < BUTTONS; ++i)
+  {
+    uint64_t const bit = (uint64_t)1 << i;
+
+    if (random() % 200 == 0)
+    {
+      *level ^= bit;
+      bounce[i] = random() % 8;
+    }
+
+    raw |= *level & bit;
+
+    if (bounce[i] > 0 ? (--bounce[i], random() % 2) : random() % 100 == 0)
+    {
+      raw ^= bit;
+    }
+  }
+
+  return raw;
+}
+
+#define BUTTONS_TEST(name, type, word, bits)                                   \
+  TEST name(unsigned long_ticks)                                               \
+  {                                                                            \
+    struct reference ref[BUTTONS];                                             \
+    unsigned bounce[BUTTONS] = {0};                                            \
+    uint64_t level = (uint64_t)random() << 32 | (uint64_t)random();            \
+    type b;                                                                    \
+                                                                               \
+    type##_init(&b, (word)level, long_ticks);                                  \
+    for (unsigned i = 0; i < bits; ++i)                                        \
+    {                                                                          \
+      reference_init(&ref[i], level >> i & 1);                                 \
+    }                                                                          \
+                                                                               \
+    for (int k = 0; k < SCANS; ++k)                                            \
+    {                                                                          \
+      uint64_t const raw = scan(&level, bounce);                               \
+                                                                               \
+      type##_update(&b, (word)raw);                                            \
+                                                                               \
+      for (unsigned i = 0; i < bits; ++i)                                      \
+      {                                                                        \
+        unsigned const events =                                                \
+            reference_update(&ref[i], raw >> i & 1, long_ticks);               \
+                                                                               \
+        ASSERT_EQ_FMT(ref[i].state, (unsigned)(b.state >> i & 1), "%u");       \
+        ASSERT_EQ_FMT(events & PRESSED ? 1u : 0u,                              \
+                      (unsigned)(b.pressed >> i & 1), "%u");                   \
+        ASSERT_EQ_FMT(events & RELEASED ? 1u : 0u,                             \
+                      (unsigned)(b.released >> i & 1), "%u");                  \
+        ASSERT_EQ_FMT(events & LONG_PRESSED ? 1u : 0u,                         \
+                      (unsigned)(b.long_pressed >> i & 1), "%u");              \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    PASS();                                                                    \
+  }
+
+BUTTONS_TEST(buttons8, encoder_buttons8, encoder_byte_t, 8)
+BUTTONS_TEST(buttons32, encoder_buttons32, uint32_t, 32)
+BUTTONS_TEST(buttons64, encoder_buttons64, uint64_t, 64)
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  static unsigned const long_ticks[] = {0, 1, 2, 5, 50, 300, 1023};
+
+  GREATEST_MAIN_BEGIN();
+
+  srandom(42);
+
+  for (size_t i = 0; i < sizeof(long_ticks) / sizeof(long_ticks[0]); ++i)
+  {
+    RUN_TESTp(buttons8, long_ticks[i]);
+    RUN_TESTp(buttons32, long_ticks[i]);
+    RUN_TESTp(buttons64, long_ticks[i]);
+  }
+
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/coalesce.h>
+
+enum
+{
+  ENCODERS = 70
+};
+
+TEST threshold(void)
+{
+  encoder_position_t deltas[2] = {0, 0};
+  encoder_coalescer* c = encoder_coalescer_create(2, 1000, 3);
+
+  ASSERT(c);
+
+  encoder_coalescer_add_action(c, 1, ENCODER_ACTION_TURN_CW, 0);
+  encoder_coalescer_add_action(c, 1, ENCODER_ACTION_NONE, 1);
+  encoder_coalescer_add_action(c, 1, ENCODER_ACTION_TURN_CW, 2);
+  ASSERT_EQ(0, encoder_coalescer_drain(c, deltas));
+
+  encoder_coalescer_add_action(c, 1, ENCODER_ACTION_TURN_CW, 3);
+  ASSERT_EQ(1, encoder_coalescer_drain(c, deltas));
+  ASSERT_EQ(0, deltas[0]);
+  ASSERT_EQ(3, deltas[1]);
+
+  /* actions that cancel out are never released */
+  encoder_coalescer_add(c, 0, -2, 4);
+  encoder_coalescer_add(c, 0, 2, 5);
+  encoder_coalescer_add(c, 0, -5, 6);
+  ASSERT_EQ(1, encoder_coalescer_drain(c, deltas));
+  ASSERT_EQ(-5, deltas[0]);
+  ASSERT_EQ(2, encoder_coalescer_releases(c));
+
+  encoder_coalescer_destroy(c);
+
+  PASS();
+}
+
+TEST latency(void)
+{
+  encoder_position_t deltas[ENCODERS] = {0};
+  encoder_coalescer* c = encoder_coalescer_create(ENCODERS, 100, 1000);
+
+  ASSERT(c);
+
+  encoder_coalescer_add(c, 5, 1, 1000);
+  encoder_coalescer_add(c, 69, -1, 1050);
+  encoder_coalescer_add(c, 5, 1, 1099);
+  encoder_coalescer_poll(c, 1099);
+  ASSERT_EQ(0, encoder_coalescer_drain(c, deltas));
+
+  /* the latency counts from the first unreleased action */
+  encoder_coalescer_add(c, 5, 1, 1100);
+  ASSERT_EQ(1, encoder_coalescer_drain(c, deltas));
+  ASSERT_EQ(3, deltas[5]);
+
+  encoder_coalescer_poll(c, 1149);
+  ASSERT_EQ(0, encoder_coalescer_drain(c, deltas));
+  encoder_coalescer_poll(c, 1150);
+  ASSERT_EQ(1, encoder_coalescer_drain(c, deltas));
+  ASSERT_EQ(-1, deltas[69]);
+
+  encoder_coalescer_add(c, 0, 7, 2000);
+  encoder_coalescer_add(c, 64, -7, 2000);
+  encoder_coalescer_flush(c);
+  ASSERT_EQ(2, encoder_coalescer_drain(c, deltas));
+  ASSERT_EQ(7, deltas[0]);
+  ASSERT_EQ(-7, deltas[64]);
+
+  encoder_coalescer_destroy(c);
+
+  PASS();
+}
+
+struct producer
+{
+  encoder_coalescer* c;
+  encoder_position_t total[ENCODERS];
+  atomic_int done;
+};
+
+static void* produce(void* arg)
+{
+  struct producer* p = arg;
+  unsigned seed = 42;
+
+  for (uint64_t now = 0; now < 2000000; ++now)
+  {
+    size_t const i = rand_r(&seed) % ENCODERS;
+    encoder_position_t const delta = rand_r(&seed) % 5 - 2;
+
+    encoder_coalescer_add(p->c, i, delta, now);
+    p->total[i] += delta;
+
+    if (now % 64 == 0)
+    {
+      encoder_coalescer_poll(p->c, now);
+    }
+  }
+
+  encoder_coalescer_flush(p->c);
+  atomic_store(&p->done, 1);
+
+  return NULL;
+}
+
+TEST concurrent(void)
+{
+  static struct producer p;
+  encoder_position_t deltas[ENCODERS] = {0};
+  pthread_t thread;
+  int done;
+
+  p.c = encoder_coalescer_create(ENCODERS, 500, 20);
+  ASSERT(p.c);
+
+  ASSERT_EQ(0, pthread_create(&thread, NULL, produce, &p));
+
+  do
+  {
+    done = atomic_load(&p.done);
+    encoder_coalescer_drain(p.c, deltas);
+  } while (!done);
+
+  ASSERT_EQ(0, pthread_join(thread, NULL));
+
+  for (size_t i = 0; i < ENCODERS; ++i)
+  {
+    ASSERT_EQ_FMT(p.total[i], deltas[i], "%ld");
+  }
+
+  ASSERT_GT(encoder_coalescer_releases(p.c), 1000);
+  ASSERT_LT(encoder_coalescer_releases(p.c), 2000000 / 4);
+
+  encoder_coalescer_destroy(p.c);
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TEST(threshold);
+  RUN_TEST(latency);
+  RUN_TEST(concurrent);
+
+  GREATEST_MAIN_END();
+}
@@ -70,12 +70,36 @@ int main(int argc, char** argv)
   RUN_TESTp(compare, encoder_simple_half_step_init,
             encoder_simple_half_step_update,
             encoder_simple_half_step_update_tt);
+  RUN_TESTp(compare, encoder_simple_quarter_step_init,
+            encoder_simple_quarter_step_update,
+            encoder_simple_quarter_step_update_tt);
+  RUN_TESTp(compare, encoder_simple_full_step_init,
+            encoder_simple_full_step_update_imm,
+            encoder_simple_full_step_update_tt);
+  RUN_TESTp(compare, encoder_simple_half_step_init,
+            encoder_simple_half_step_update_imm,
+            encoder_simple_half_step_update_tt);
+  RUN_TESTp(compare, encoder_simple_quarter_step_init,
+            encoder_simple_quarter_step_update_imm,
+            encoder_simple_quarter_step_update_tt);
   RUN_TESTp(compare, encoder_debounced_full_step_init,
             encoder_debounced_full_step_update,
             encoder_debounced_full_step_update_tt);
   RUN_TESTp(compare, encoder_debounced_half_step_init,
             encoder_debounced_half_step_update,
             encoder_debounced_half_step_update_tt);
+  RUN_TESTp(compare, encoder_debounced_full_step_init,
+            encoder_debounced_full_step_update_branchless,
+            encoder_debounced_full_step_update_tt);
+  RUN_TESTp(compare, encoder_debounced_half_step_init,
+            encoder_debounced_half_step_update_branchless,
+            encoder_debounced_half_step_update_tt);
+  RUN_TESTp(compare, encoder_debounced_full_step_recovering_init,
+            encoder_debounced_full_step_recovering_update,
+            encoder_debounced_full_step_recovering_update_tt);
+  RUN_TESTp(compare, encoder_debounced_half_step_recovering_init,
+            encoder_debounced_half_step_recovering_update,
+            encoder_debounced_half_step_recovering_update_tt);
 
   GREATEST_MAIN_END();
 }
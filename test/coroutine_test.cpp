@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <vector>
+
+#define GREATEST_VA_ARGS
+
+#include <greatest.h>
+
+#include <rotaryencoder/coroutine.h>
+#include <rotaryencoder/simple_encoder.h>
+
+namespace
+{
+
+std::size_t heap_allocations = 0;
+
+using knob = rotaryencoder::awaitable_encoder<
+    rotaryencoder::simple_encoder_quarter_step_tt>;
+
+encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+
+/* turns the knob by one quarter step in the given direction */
+void turn(knob& k, unsigned& pos, int dir)
+{
+  pos += dir;
+  k.update(gray[pos % 4]);
+}
+
+rotaryencoder::step_task count_steps(knob& k, int steps, long& position)
+{
+  while (steps-- > 0)
+  {
+    auto step = co_await k.next_step();
+    position += step == ENCODER_ACTION_TURN_CW ? 1 : -1;
+  }
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+  void* p = std::malloc(size ? size : 1);
+
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+
+  ++heap_allocations;
+
+  return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+TEST await_steps()
+{
+  rotaryencoder::step_scheduler sched;
+  knob k(sched, gray[0]);
+  unsigned pos = 0;
+  long position = 0;
+  auto task = count_steps(k, 3, position);
+
+  ASSERT(task.valid());
+  ASSERT(k.waiting());
+
+  /* nothing is resumed until the scheduler runs */
+  turn(k, pos, 1);
+  ASSERT_EQ(0, position);
+  ASSERT_FALSE(k.waiting());
+  ASSERT_EQ(1u, sched.run());
+  ASSERT_EQ(1, position);
+  ASSERT(k.waiting());
+
+  /* steps decoded while the coroutine isn't waiting are not queued */
+  turn(k, pos, -1);
+  turn(k, pos, -1);
+  ASSERT_EQ(1u, sched.run());
+  ASSERT_EQ(0, position);
+
+  ASSERT_EQ(0u, sched.run());
+
+  turn(k, pos, -1);
+  ASSERT_EQ(1u, sched.run());
+  ASSERT_EQ(-1, position);
+
+  /* the coroutine has returned */
+  ASSERT_FALSE(k.waiting());
+  turn(k, pos, 1);
+  ASSERT(sched.empty());
+
+  PASS();
+}
+
+TEST many_coroutines()
+{
+  enum
+  {
+    KNOBS = 10,
+    COROUTINES = 2000,
+    STEPS = 5
+  };
+
+  static rotaryencoder::static_frame_pool<256, COROUTINES> pool;
+  rotaryencoder::step_scheduler sched;
+  std::deque<knob> knobs;
+  std::vector<long> positions(COROUTINES, 0);
+  unsigned pos[KNOBS] = {0};
+  std::size_t allocations;
+
+  for (int i = 0; i < KNOBS; ++i)
+  {
+    knobs.emplace_back(sched, gray[0]);
+  }
+
+  allocations = heap_allocations;
+
+  {
+    rotaryencoder::frame_pool::use use(pool);
+
+    for (int c = 0; c < COROUTINES; ++c)
+    {
+      ASSERT(count_steps(knobs[c % KNOBS], STEPS, positions[c]).valid());
+    }
+
+    /* the pool is exhausted */
+    ASSERT_FALSE(count_steps(knobs[0], STEPS, positions[0]).valid());
+  }
+
+  for (int s = 0; s < STEPS; ++s)
+  {
+    for (int i = 0; i < KNOBS; ++i)
+    {
+      turn(knobs[i], pos[i], i % 2 ? -1 : 1);
+    }
+
+    ASSERT_EQ((std::size_t)COROUTINES, sched.run());
+  }
+
+  /* neither the frames nor the awaits have used the heap */
+  ASSERT_EQ(allocations, heap_allocations);
+
+  for (int c = 0; c < COROUTINES; ++c)
+  {
+    ASSERT_EQ(c % KNOBS % 2 ? -STEPS : STEPS, positions[c]);
+  }
+
+  for (int i = 0; i < KNOBS; ++i)
+  {
+    ASSERT_FALSE(knobs[i].waiting());
+  }
+
+  /* all frames have been returned to the pool */
+  {
+    rotaryencoder::frame_pool::use use(pool);
+
+    for (int c = 0; c < COROUTINES; ++c)
+    {
+      ASSERT(count_steps(knobs[c % KNOBS], 1, positions[c]).valid());
+    }
+  }
+
+  for (int i = 0; i < KNOBS; ++i)
+  {
+    turn(knobs[i], pos[i], 1);
+  }
+
+  ASSERT_EQ((std::size_t)COROUTINES, sched.run());
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TEST(await_steps);
+  RUN_TEST(many_coroutines);
+
+  GREATEST_MAIN_END();
+}
@@ -27,6 +27,8 @@
 #include <greatest.h>
 
 #include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/dispatch.h>
+#include <rotaryencoder/index_encoder.h>
 #include <rotaryencoder/simple_encoder.h>
 
 TEST cpp_simple_full()
@@ -35,6 +37,7 @@ TEST cpp_simple_full()
 
   rotaryencoder::simple_encoder_full_step enc(term);
   rotaryencoder::simple_encoder_full_step_tt enc_tt(term);
+  rotaryencoder::simple_encoder_full_step_imm enc_imm(term);
 
   for (int k = 0; k < 1000; ++k)
   {
@@ -42,8 +45,11 @@ TEST cpp_simple_full()
 
     enum encoder_action action = enc.update(term);
     enum encoder_action action_tt = enc_tt.update(term);
+    enum encoder_action action_imm = enc_imm.update(term);
 
     ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_tt), "%d");
+    ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_imm),
+                  "%d");
   }
 
   PASS();
@@ -55,6 +61,7 @@ TEST cpp_simple_half()
 
   rotaryencoder::simple_encoder_half_step enc(term);
   rotaryencoder::simple_encoder_half_step_tt enc_tt(term);
+  rotaryencoder::simple_encoder_half_step_imm enc_imm(term);
 
   for (int k = 0; k < 1000; ++k)
   {
@@ -62,8 +69,35 @@ TEST cpp_simple_half()
 
     enum encoder_action action = enc.update(term);
     enum encoder_action action_tt = enc_tt.update(term);
+    enum encoder_action action_imm = enc_imm.update(term);
 
     ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_tt), "%d");
+    ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_imm),
+                  "%d");
+  }
+
+  PASS();
+}
+
+TEST cpp_simple_quarter()
+{
+  encoder_fast_byte_t term = ::random() % 4;
+
+  rotaryencoder::simple_encoder_quarter_step enc(term);
+  rotaryencoder::simple_encoder_quarter_step_tt enc_tt(term);
+  rotaryencoder::simple_encoder_quarter_step_imm enc_imm(term);
+
+  for (int k = 0; k < 1000; ++k)
+  {
+    term = ::random() % 4;
+
+    enum encoder_action action = enc.update(term);
+    enum encoder_action action_tt = enc_tt.update(term);
+    enum encoder_action action_imm = enc_imm.update(term);
+
+    ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_tt), "%d");
+    ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_imm),
+                  "%d");
   }
 
   PASS();
@@ -75,6 +109,7 @@ TEST cpp_debounced_full()
 
   rotaryencoder::debounced_encoder_full_step enc(term);
   rotaryencoder::debounced_encoder_full_step_tt enc_tt(term);
+  rotaryencoder::debounced_encoder_full_step_branchless enc_bl(term);
 
   for (int k = 0; k < 1000; ++k)
   {
@@ -82,8 +117,10 @@ TEST cpp_debounced_full()
 
     enum encoder_action action = enc.update(term);
     enum encoder_action action_tt = enc_tt.update(term);
+    enum encoder_action action_bl = enc_bl.update(term);
 
     ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_tt), "%d");
+    ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_bl), "%d");
   }
 
   PASS();
@@ -95,6 +132,29 @@ TEST cpp_debounced_half()
 
   rotaryencoder::debounced_encoder_half_step enc(term);
   rotaryencoder::debounced_encoder_half_step_tt enc_tt(term);
+  rotaryencoder::debounced_encoder_half_step_branchless enc_bl(term);
+
+  for (int k = 0; k < 1000; ++k)
+  {
+    term = ::random() % 4;
+
+    enum encoder_action action = enc.update(term);
+    enum encoder_action action_tt = enc_tt.update(term);
+    enum encoder_action action_bl = enc_bl.update(term);
+
+    ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_tt), "%d");
+    ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_bl), "%d");
+  }
+
+  PASS();
+}
+
+TEST cpp_debounced_full_recovering()
+{
+  encoder_fast_byte_t term = ::random() % 4;
+
+  rotaryencoder::debounced_encoder_full_step_recovering enc(term);
+  rotaryencoder::debounced_encoder_full_step_recovering_tt enc_tt(term);
 
   for (int k = 0; k < 1000; ++k)
   {
@@ -109,6 +169,68 @@ TEST cpp_debounced_half()
   PASS();
 }
 
+TEST cpp_debounced_half_recovering()
+{
+  encoder_fast_byte_t term = ::random() % 4;
+
+  rotaryencoder::debounced_encoder_half_step_recovering enc(term);
+  rotaryencoder::debounced_encoder_half_step_recovering_tt enc_tt(term);
+
+  for (int k = 0; k < 1000; ++k)
+  {
+    term = ::random() % 4;
+
+    enum encoder_action action = enc.update(term);
+    enum encoder_action action_tt = enc_tt.update(term);
+
+    ASSERT_EQ_FMT(static_cast<int>(action), static_cast<int>(action_tt), "%d");
+  }
+
+  PASS();
+}
+
+TEST cpp_edges()
+{
+  rotaryencoder::debounced_encoder_full_step_tt enc(0x3);
+  rotaryencoder::simple_encoder_full_step_tt enc_simple(0x3);
+
+  ASSERT_EQ(ENCODER_EDGE_A_FALLING | ENCODER_EDGE_B_FALLING, enc.edges(0x3));
+  ASSERT_EQ(ENCODER_EDGE_B_FALLING, enc_simple.edges(0x3));
+
+  enc.update(0x2);
+  enc.update(0x0);
+
+  ASSERT_EQ(ENCODER_EDGE_A_RISING, enc.edges(0x0));
+
+  PASS();
+}
+
+TEST cpp_index()
+{
+  rotaryencoder::index_encoder<rotaryencoder::simple_encoder_quarter_step> enc(
+      ENCODER_TERMINAL_A | ENCODER_TERMINAL_B);
+
+  enc.home(100);
+
+  enc.update(ENCODER_TERMINAL_Z | ENCODER_TERMINAL_B);
+  enc.update(ENCODER_TERMINAL_Z);
+  enc.update(ENCODER_TERMINAL_Z | ENCODER_TERMINAL_A);
+  ASSERT_FALSE(enc.latched());
+  ASSERT_EQ(3, enc.position());
+
+  enc.update(ENCODER_TERMINAL_Z | ENCODER_TERMINAL_A | ENCODER_TERMINAL_B);
+  ASSERT(enc.latched());
+  ASSERT_EQ(100, enc.position());
+  ASSERT_EQ(100, enc.index_position());
+
+  enc.update(ENCODER_TERMINAL_B);
+  enc.sync(0);
+  ASSERT_EQ(1, enc.position());
+  ASSERT_EQ(0, enc.index_position());
+
+  PASS();
+}
+
 #if __cplusplus >= 201103L
 
 TEST cpp_compare_poly(rotaryencoder::encoder_interface& e1,
@@ -132,6 +254,34 @@ TEST cpp_compare_poly(rotaryencoder::encoder_interface& e1,
   PASS();
 }
 
+template <typename Encoder>
+TEST cpp_dispatch()
+{
+  encoder_fast_byte_t term = ::random() % 4;
+  int cw = 0, ccw = 0, expected_cw = 0, expected_ccw = 0;
+
+  Encoder enc(term);
+  auto disp = rotaryencoder::make_dispatching_encoder<Encoder>(
+      term, [&cw] { ++cw; }, [&ccw] { ++ccw; });
+
+  for (int k = 0; k < 1000; ++k)
+  {
+    term = ::random() % 4;
+
+    auto action = enc.update(term);
+
+    expected_cw += action == ENCODER_ACTION_TURN_CW;
+    expected_ccw += action == ENCODER_ACTION_TURN_CCW;
+
+    ASSERT_EQ_FMT(static_cast<int>(action),
+                  static_cast<int>(disp.update(term)), "%d");
+    ASSERT_EQ(expected_cw, cw);
+    ASSERT_EQ(expected_ccw, ccw);
+  }
+
+  PASS();
+}
+
 #endif
 
 GREATEST_MAIN_DEFS();
@@ -144,8 +294,13 @@ int main(int argc, char** argv)
 
   RUN_TEST(cpp_simple_full);
   RUN_TEST(cpp_simple_half);
+  RUN_TEST(cpp_simple_quarter);
   RUN_TEST(cpp_debounced_full);
   RUN_TEST(cpp_debounced_half);
+  RUN_TEST(cpp_debounced_full_recovering);
+  RUN_TEST(cpp_debounced_half_recovering);
+  RUN_TEST(cpp_edges);
+  RUN_TEST(cpp_index);
 
 #if __cplusplus >= 201103L
 
@@ -158,6 +313,13 @@ int main(int argc, char** argv)
     RUN_TESTp(cpp_compare_poly, enc, enc_tt);
   }
 
+  {
+    encoder_poly_wrapper<simple_encoder_full_step> enc;
+    encoder_poly_wrapper<simple_encoder_full_step_imm> enc_imm;
+
+    RUN_TESTp(cpp_compare_poly, enc, enc_imm);
+  }
+
   {
     encoder_poly_wrapper<simple_encoder_half_step> enc;
     encoder_poly_wrapper<simple_encoder_half_step_tt> enc_tt;
@@ -165,6 +327,27 @@ int main(int argc, char** argv)
     RUN_TESTp(cpp_compare_poly, enc, enc_tt);
   }
 
+  {
+    encoder_poly_wrapper<simple_encoder_half_step> enc;
+    encoder_poly_wrapper<simple_encoder_half_step_imm> enc_imm;
+
+    RUN_TESTp(cpp_compare_poly, enc, enc_imm);
+  }
+
+  {
+    encoder_poly_wrapper<simple_encoder_quarter_step> enc;
+    encoder_poly_wrapper<simple_encoder_quarter_step_tt> enc_tt;
+
+    RUN_TESTp(cpp_compare_poly, enc, enc_tt);
+  }
+
+  {
+    encoder_poly_wrapper<simple_encoder_quarter_step> enc;
+    encoder_poly_wrapper<simple_encoder_quarter_step_imm> enc_imm;
+
+    RUN_TESTp(cpp_compare_poly, enc, enc_imm);
+  }
+
   {
     encoder_poly_wrapper<debounced_encoder_full_step> enc;
     encoder_poly_wrapper<debounced_encoder_full_step_tt> enc_tt;
@@ -172,6 +355,13 @@ int main(int argc, char** argv)
     RUN_TESTp(cpp_compare_poly, enc, enc_tt);
   }
 
+  {
+    encoder_poly_wrapper<debounced_encoder_full_step> enc;
+    encoder_poly_wrapper<debounced_encoder_full_step_branchless> enc_bl;
+
+    RUN_TESTp(cpp_compare_poly, enc, enc_bl);
+  }
+
   {
     encoder_poly_wrapper<debounced_encoder_half_step> enc;
     encoder_poly_wrapper<debounced_encoder_half_step_tt> enc_tt;
@@ -179,6 +369,39 @@ int main(int argc, char** argv)
     RUN_TESTp(cpp_compare_poly, enc, enc_tt);
   }
 
+  {
+    encoder_poly_wrapper<debounced_encoder_half_step> enc;
+    encoder_poly_wrapper<debounced_encoder_half_step_branchless> enc_bl;
+
+    RUN_TESTp(cpp_compare_poly, enc, enc_bl);
+  }
+
+  {
+    encoder_poly_wrapper<debounced_encoder_full_step_recovering> enc;
+    encoder_poly_wrapper<debounced_encoder_full_step_recovering_tt> enc_tt;
+
+    RUN_TESTp(cpp_compare_poly, enc, enc_tt);
+  }
+
+  {
+    encoder_poly_wrapper<debounced_encoder_half_step_recovering> enc;
+    encoder_poly_wrapper<debounced_encoder_half_step_recovering_tt> enc_tt;
+
+    RUN_TESTp(cpp_compare_poly, enc, enc_tt);
+  }
+
+  RUN_TEST(cpp_dispatch<rotaryencoder::simple_encoder_full_step_tt>);
+  RUN_TEST(cpp_dispatch<rotaryencoder::simple_encoder_half_step_tt>);
+  RUN_TEST(cpp_dispatch<rotaryencoder::simple_encoder_quarter_step_tt>);
+  RUN_TEST(cpp_dispatch<rotaryencoder::simple_encoder_quarter_step_imm>);
+  RUN_TEST(cpp_dispatch<rotaryencoder::debounced_encoder_full_step>);
+  RUN_TEST(cpp_dispatch<rotaryencoder::debounced_encoder_full_step_tt>);
+  RUN_TEST(cpp_dispatch<rotaryencoder::debounced_encoder_half_step_tt>);
+  RUN_TEST(
+      cpp_dispatch<rotaryencoder::debounced_encoder_full_step_recovering_tt>);
+  RUN_TEST(
+      cpp_dispatch<rotaryencoder::debounced_encoder_half_step_recovering_tt>);
+
 #endif
 
   GREATEST_MAIN_END();
@@ -235,5 +235,9 @@ int main(int argc, char** argv)
   RUN_TESTp(initial_state, encoder_debounced_full_step_update_tt);
   RUN_TESTp(error, encoder_debounced_full_step_update_tt);
 
+  RUN_TESTp(basic, encoder_debounced_full_step_update_branchless);
+  RUN_TESTp(initial_state, encoder_debounced_full_step_update_branchless);
+  RUN_TESTp(error, encoder_debounced_full_step_update_branchless);
+
   GREATEST_MAIN_END();
 }
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/dispatch.h>
+
+typedef encoder_byte_t ENCODER_CONST_MEMORY (*table_type)[4];
+
+/*
+ * The handlers of ENCODER_DISPATCH_TT() must run exactly for the actions
+ * returned by the regular update.
+ */
+TEST dispatch(table_type table, encoder_byte_t states)
+{
+  encoder_byte_t first;
+
+  for (first = 0; first < states; ++first)
+  {
+    encoder_state s = first, s_dispatch = first;
+    int k;
+
+    for (k = 0; k < 1000; ++k)
+    {
+      encoder_fast_byte_t const terminal = random() % 4;
+      enum encoder_action const action =
+          encoder_internal_update_tt(&s, terminal, table);
+      int cw = 0, ccw = 0;
+
+      ENCODER_DISPATCH_TT(&s_dispatch, terminal, table, ++cw, ++ccw);
+
+      ASSERT_EQ(s, s_dispatch);
+      ASSERT_EQ(action == ENCODER_ACTION_TURN_CW, cw);
+      ASSERT_EQ(action == ENCODER_ACTION_TURN_CCW, ccw);
+    }
+  }
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TESTp(dispatch, encoder_simple_full_step_table, 4);
+  RUN_TESTp(dispatch, encoder_simple_half_step_table, 4);
+  RUN_TESTp(dispatch, encoder_simple_quarter_step_table, 4);
+  RUN_TESTp(dispatch, encoder_debounced_full_step_table, 7);
+  RUN_TESTp(dispatch, encoder_debounced_half_step_table, 6);
+  RUN_TESTp(dispatch, encoder_debounced_full_step_recovering_table, 13);
+  RUN_TESTp(dispatch, encoder_debounced_half_step_recovering_table, 10);
+
+  GREATEST_MAIN_END();
+}
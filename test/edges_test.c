@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/simple_encoder.h>
+
+typedef void (*init_func)(encoder_state*, encoder_byte_t);
+
+typedef enum encoder_action (*update_func)(encoder_state*, encoder_fast_byte_t);
+
+typedef encoder_fast_byte_t (*edges_func)(encoder_state const*,
+                                          encoder_fast_byte_t);
+
+static void simple_full_step_init(encoder_state* s, encoder_byte_t terminal)
+{
+  encoder_simple_full_step_init(s, terminal);
+}
+
+static void simple_half_step_init(encoder_state* s, encoder_byte_t terminal)
+{
+  encoder_simple_half_step_init(s, terminal);
+}
+
+static void simple_quarter_step_init(encoder_state* s, encoder_byte_t terminal)
+{
+  encoder_simple_quarter_step_init(s, terminal);
+}
+
+/*
+ * Turn the encoder randomly, with contact bounce, and feed each terminal
+ * edge to an encoder that observes all edges, and to one that only
+ * observes the edges it asks for. Both must generate the same actions at
+ * the same time. Returns the number of updates of the latter in `*updates`
+ * and the total number of edges in `*edges`.
+ */
+TEST simulate(init_func init, update_func update, edges_func edges,
+              int bounce, long* updates, long* total)
+{
+  static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+
+  unsigned pos = random() % 4;
+  encoder_fast_byte_t term = gray[pos];
+  encoder_state es, es_armed;
+
+  init(&es, term);
+  init(&es_armed, term);
+
+  for (int i = 0; i < 10000; ++i)
+  {
+    encoder_fast_byte_t pin;
+    int toggles = 1 + 2 * (bounce ? random() % (bounce + 1) : 0);
+
+    pos += random() % 4 == 0 ? -1 : 1;
+    pin = term ^ gray[pos % 4];
+
+    while (toggles-- > 0)
+    {
+      encoder_fast_byte_t const armed = edges(&es_armed, term);
+      enum encoder_action action, action_armed = ENCODER_ACTION_NONE;
+
+      /* only a single pin must change between updates */
+      ASSERT_EQ(1, pin == ENCODER_TERMINAL_A || pin == ENCODER_TERMINAL_B);
+
+      /* only the edges leading away from the current level are armed */
+      ASSERT_EQ(0, armed & (term | ((term << 2) ^ 0xC)));
+
+      term ^= pin;
+      action = update(&es, term);
+      ++*total;
+
+      if (armed & (pin | pin << 2))
+      {
+        action_armed = update(&es_armed, term);
+        ++*updates;
+      }
+
+      ASSERT_EQ_FMT((int)action, (int)action_armed, "%d");
+    }
+  }
+
+  PASS();
+}
+
+TEST masking(init_func init, update_func update, edges_func edges,
+             int saves)
+{
+  long updates = 0, total = 0;
+
+  CHECK_CALL(simulate(init, update, edges, 0, &updates, &total));
+  CHECK_CALL(simulate(init, update, edges, 3, &updates, &total));
+
+  if (saves)
+  {
+    ASSERT_LT(updates, total);
+  }
+  else
+  {
+    ASSERT_EQ(updates, total);
+  }
+
+  PASS();
+}
+
+TEST full_step_detent(void)
+{
+  encoder_state es;
+
+  encoder_debounced_full_step_init(&es, 0x3);
+
+  /* both directions are possible at the detent */
+  ASSERT_EQ(ENCODER_EDGE_A_FALLING | ENCODER_EDGE_B_FALLING,
+            encoder_debounced_full_step_edges_tt(&es, 0x3));
+
+  ASSERT_EQ(ENCODER_ACTION_NONE, encoder_debounced_full_step_update_tt(&es, 2));
+  ASSERT_EQ(ENCODER_ACTION_NONE, encoder_debounced_full_step_update_tt(&es, 0));
+
+  /* B bouncing back to 10 doesn't matter when turning clockwise */
+  ASSERT_EQ(ENCODER_EDGE_A_RISING,
+            encoder_debounced_full_step_edges_tt(&es, 0x0));
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  srandom(42);
+
+  RUN_TESTp(masking, simple_full_step_init, encoder_simple_full_step_update_tt,
+            encoder_simple_full_step_edges_tt, 1);
+  RUN_TESTp(masking, simple_full_step_init, encoder_simple_full_step_update,
+            encoder_simple_full_step_edges_tt, 1);
+  RUN_TESTp(masking, simple_half_step_init, encoder_simple_half_step_update_tt,
+            encoder_simple_half_step_edges_tt, 0);
+  RUN_TESTp(masking, simple_quarter_step_init,
+            encoder_simple_quarter_step_update_tt,
+            encoder_simple_quarter_step_edges_tt, 0);
+  RUN_TESTp(masking, encoder_debounced_full_step_init,
+            encoder_debounced_full_step_update_tt,
+            encoder_debounced_full_step_edges_tt, 1);
+  RUN_TESTp(masking, encoder_debounced_half_step_init,
+            encoder_debounced_half_step_update_tt,
+            encoder_debounced_half_step_edges_tt, 0);
+  RUN_TESTp(masking, encoder_debounced_full_step_recovering_init,
+            encoder_debounced_full_step_recovering_update_tt,
+            encoder_debounced_full_step_recovering_edges_tt, 1);
+  RUN_TESTp(masking, encoder_debounced_half_step_recovering_init,
+            encoder_debounced_half_step_recovering_update_tt,
+            encoder_debounced_half_step_recovering_edges_tt, 1);
+
+  RUN_TEST(full_step_detent);
+
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/fused.h>
+#include <rotaryencoder/simple_encoder.h>
+
+typedef encoder_byte_t ENCODER_CONST_MEMORY (*table_type)[4];
+typedef encoder_fused_t ENCODER_CONST_MEMORY (*fused_table_type)[4];
+
+/*
+ * A fused word must track the state of the regular update and count its
+ * actions, for every initial state.
+ */
+TEST fused(table_type table, fused_table_type fused_table,
+           encoder_byte_t states)
+{
+  encoder_byte_t first;
+
+  for (first = 0; first < states; ++first)
+  {
+    encoder_state s = first;
+    encoder_position_t position = 0;
+    encoder_fused_t w;
+    int k;
+
+    encoder_fused_init(&w, first);
+
+    for (k = 0; k < 10000; ++k)
+    {
+      encoder_fast_byte_t const terminal = random() % 4;
+
+      switch (encoder_internal_update_tt(&s, terminal, table))
+      {
+      case ENCODER_ACTION_TURN_CW:
+        ++position;
+        break;
+      case ENCODER_ACTION_TURN_CCW:
+        --position;
+        break;
+      case ENCODER_ACTION_NONE:
+        break;
+      }
+
+      encoder_fused_update(&w, terminal, fused_table);
+
+      ASSERT_EQ(s, encoder_fused_state(w));
+      ASSERT_EQ(position, encoder_fused_position(w));
+    }
+  }
+
+  PASS();
+}
+
+/*
+ * Turning continuously in one direction must count far into negative
+ * positions, and wrap around at the end of the word.
+ */
+TEST fused_range(void)
+{
+  static encoder_byte_t const gray[4] = {0x0, 0x1, 0x3, 0x2};
+  encoder_position_t const max =
+      (encoder_position_t)(((encoder_fused_t)~(encoder_fused_t)0 >> 1) >>
+                           ENCODER_INTERNAL_FUSED_SHIFT);
+  encoder_state s;
+  encoder_fused_t w;
+  int k;
+
+  encoder_simple_quarter_step_init(&s, gray[0]);
+  encoder_fused_init(&w, s);
+
+  for (k = 1; k <= 1000; ++k)
+  {
+    encoder_fused_update(&w, gray[(1000 - k) % 4],
+                         encoder_simple_quarter_step_fused_table);
+    ASSERT_EQ(-k, encoder_fused_position(w));
+  }
+
+  w = (encoder_fused_t)((encoder_fused_t)max << ENCODER_INTERNAL_FUSED_SHIFT |
+                        encoder_fused_state(w));
+  ASSERT_EQ(max, encoder_fused_position(w));
+
+  encoder_fused_update(&w, gray[1],
+                       encoder_simple_quarter_step_fused_table);
+  ASSERT_EQ(-max - 1, encoder_fused_position(w));
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TESTp(fused, encoder_simple_full_step_table,
+            encoder_simple_full_step_fused_table, 4);
+  RUN_TESTp(fused, encoder_simple_half_step_table,
+            encoder_simple_half_step_fused_table, 4);
+  RUN_TESTp(fused, encoder_simple_quarter_step_table,
+            encoder_simple_quarter_step_fused_table, 4);
+  RUN_TESTp(fused, encoder_debounced_full_step_table,
+            encoder_debounced_full_step_fused_table, 7);
+  RUN_TESTp(fused, encoder_debounced_half_step_table,
+            encoder_debounced_half_step_fused_table, 6);
+  RUN_TESTp(fused, encoder_debounced_full_step_recovering_table,
+            encoder_debounced_full_step_recovering_fused_table, 13);
+  RUN_TESTp(fused, encoder_debounced_half_step_recovering_table,
+            encoder_debounced_half_step_recovering_fused_table, 10);
+  RUN_TEST(fused_range);
+
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <greatest.h>
+
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/index_encoder.h>
+#include <rotaryencoder/simple_encoder.h>
+
+typedef void (*init_func)(encoder_state*, encoder_fast_byte_t);
+
+typedef enum encoder_action (*update_func)(encoder_state*, encoder_fast_byte_t);
+
+struct simulation
+{
+  encoder_state es;
+  encoder_index_state is;
+  update_func update;
+  int angle;
+  int period;
+};
+
+static void simulation_init(struct simulation* sim, init_func init,
+                            update_func update, int period)
+{
+  init(&sim->es, ENCODER_TERMINAL_A | ENCODER_TERMINAL_B);
+  encoder_index_init(&sim->is);
+  sim->update = update;
+  sim->angle = 0;
+  sim->period = period;
+}
+
+static int step(struct simulation* sim, encoder_fast_byte_t terminal)
+{
+  return encoder_index_update(&sim->is, terminal,
+                              sim->update(&sim->es, terminal & 0x3));
+}
+
+/*
+ * Turn the encoder by `steps` full steps, raising the (gated) index
+ * terminal every `period` full steps. Returns the number of index
+ * pulses seen.
+ */
+static int turn(struct simulation* sim, int steps)
+{
+  static encoder_byte_t const cw[4] = {ENCODER_TERMINAL_B, 0,
+                                       ENCODER_TERMINAL_A,
+                                       ENCODER_TERMINAL_A | ENCODER_TERMINAL_B};
+  static encoder_byte_t const ccw[4] = {
+      ENCODER_TERMINAL_A, 0, ENCODER_TERMINAL_B,
+      ENCODER_TERMINAL_A | ENCODER_TERMINAL_B};
+
+  encoder_byte_t const* sequence = steps < 0 ? ccw : cw;
+  int pulses = 0;
+
+  for (int i = 0; i < (steps < 0 ? -steps : steps); ++i)
+  {
+    sim->angle += steps < 0 ? -1 : 1;
+
+    for (int k = 0; k < 4; ++k)
+    {
+      encoder_fast_byte_t term = sequence[k];
+
+      if (k == 3 && sim->angle % sim->period == 0)
+      {
+        term |= ENCODER_TERMINAL_Z;
+      }
+
+      pulses += step(sim, term);
+    }
+  }
+
+  return pulses;
+}
+
+TEST direction(init_func init, update_func update, int scale)
+{
+  struct simulation sim;
+
+  simulation_init(&sim, init, update, 10);
+
+  ASSERT_EQ(1, turn(&sim, 15));
+  ASSERT_EQ(15 * scale, sim.is.position);
+  ASSERT_EQ(10 * scale, sim.is.index_position);
+  ASSERT(encoder_index_latched(&sim.is));
+  ASSERT_FALSE(encoder_index_latched(&sim.is));
+
+  ASSERT_EQ(1, turn(&sim, -12));
+  ASSERT_EQ(3 * scale, sim.is.position);
+  ASSERT_EQ(10 * scale, sim.is.index_position);
+  ASSERT(encoder_index_latched(&sim.is));
+
+  ASSERT_EQ(1, turn(&sim, 9));
+  ASSERT_EQ(12 * scale, sim.is.position);
+  ASSERT_EQ(10 * scale, sim.is.index_position);
+  ASSERT(encoder_index_latched(&sim.is));
+
+  PASS();
+}
+
+TEST gating(void)
+{
+  struct simulation sim;
+
+  simulation_init(&sim, encoder_simple_quarter_step_init,
+                  encoder_simple_quarter_step_update, 1);
+
+  /* ungated index, only latched when reaching 11 */
+  ASSERT_EQ(0, step(&sim, ENCODER_TERMINAL_Z | ENCODER_TERMINAL_B));
+  ASSERT_EQ(0, step(&sim, ENCODER_TERMINAL_Z));
+  ASSERT_EQ(0, step(&sim, ENCODER_TERMINAL_Z | ENCODER_TERMINAL_A));
+  ASSERT_EQ(1, step(&sim, ENCODER_TERMINAL_Z | ENCODER_TERMINAL_A |
+                              ENCODER_TERMINAL_B));
+  ASSERT_EQ(4, sim.is.index_position);
+
+  /* index terminal must go low before latching again */
+  ASSERT_EQ(0, step(&sim, ENCODER_TERMINAL_Z | ENCODER_TERMINAL_A));
+  ASSERT_EQ(0, step(&sim, ENCODER_TERMINAL_Z | ENCODER_TERMINAL_A |
+                              ENCODER_TERMINAL_B));
+  ASSERT_EQ(0, step(&sim, ENCODER_TERMINAL_A));
+  ASSERT_EQ(3, sim.is.position);
+  ASSERT_EQ(1, step(&sim, ENCODER_TERMINAL_Z | ENCODER_TERMINAL_A |
+                              ENCODER_TERMINAL_B));
+  ASSERT_EQ(4, sim.is.index_position);
+
+  PASS();
+}
+
+TEST homing(void)
+{
+  struct simulation sim;
+
+  simulation_init(&sim, encoder_debounced_full_step_init,
+                  encoder_debounced_full_step_update, 100);
+
+  ASSERT_EQ(0, turn(&sim, -5));
+  ASSERT_EQ(-5, sim.is.position);
+
+  encoder_index_home(&sim.is, 1000, 0);
+
+  ASSERT_EQ(1, turn(&sim, 50));
+  ASSERT_EQ(1000, sim.is.index_position);
+  ASSERT_EQ(1045, sim.is.position);
+
+  ASSERT_EQ(1, turn(&sim, 110));
+  ASSERT_EQ(1100, sim.is.index_position);
+  ASSERT_EQ(1155, sim.is.position);
+
+  encoder_index_sync(&sim.is, 2000);
+
+  ASSERT_EQ(2000, sim.is.index_position);
+  ASSERT_EQ(2055, sim.is.position);
+
+  encoder_index_home(&sim.is, 0, 1);
+
+  ASSERT_EQ(2, turn(&sim, 200));
+  ASSERT_EQ(0, sim.is.index_position);
+  ASSERT_EQ(55, sim.is.position);
+
+  ASSERT_EQ(1, turn(&sim, -100));
+  ASSERT_EQ(0, sim.is.index_position);
+  ASSERT_EQ(-45, sim.is.position);
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TESTp(direction, encoder_debounced_full_step_init,
+            encoder_debounced_full_step_update, 1);
+  RUN_TESTp(direction, encoder_debounced_full_step_init,
+            encoder_debounced_full_step_update_tt, 1);
+  RUN_TESTp(direction, encoder_debounced_half_step_init,
+            encoder_debounced_half_step_update, 2);
+  RUN_TESTp(direction, encoder_debounced_half_step_init,
+            encoder_debounced_half_step_update_tt, 2);
+  RUN_TESTp(direction, encoder_simple_quarter_step_init,
+            encoder_simple_quarter_step_update, 4);
+  RUN_TESTp(direction, encoder_simple_quarter_step_init,
+            encoder_simple_quarter_step_update_tt, 4);
+
+  RUN_TEST(gating);
+  RUN_TEST(homing);
+
+  GREATEST_MAIN_END();
+}
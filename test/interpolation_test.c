@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/interpolation.h>
+
+static double const two_pi = 6.283185307179586;
+
+static long angle_error(unsigned angle, double expected)
+{
+  long const diff = ((long)angle - lround(expected)) & 0xFFFF;
+  return diff >= 0x8000 ? 0x10000 - diff : diff;
+}
+
+TEST cordic(double radius, long tolerance)
+{
+  for (unsigned k = 0; k < 4096; ++k)
+  {
+    int const x = (int)lround(radius * cos(two_pi * k / 4096));
+    int const y = (int)lround(radius * sin(two_pi * k / 4096));
+    double expected = atan2(y, x) / two_pi * 65536;
+
+    if (expected < 0)
+    {
+      expected += 65536;
+    }
+
+    ASSERT_GTE(tolerance, angle_error(encoder_cordic_atan2(y, x), expected));
+  }
+
+  PASS();
+}
+
+TEST cordic_axes(void)
+{
+  ASSERT_EQ_FMT(0u, encoder_cordic_atan2(0, 1000), "%u");
+  ASSERT_EQ_FMT(16384u, encoder_cordic_atan2(1000, 0), "%u");
+  ASSERT_EQ_FMT(32768u, encoder_cordic_atan2(0, -1000), "%u");
+  ASSERT_EQ_FMT(49152u, encoder_cordic_atan2(-1000, 0), "%u");
+  ASSERT_EQ_FMT(8192u, encoder_cordic_atan2(32767, 32767), "%u");
+  ASSERT_EQ_FMT(40960u, encoder_cordic_atan2(-32767, -32767), "%u");
+
+  PASS();
+}
+
+static int noisy(double x, int noise)
+{
+  return (int)lround(x) + (noise > 0 ? (int)(random() % (2 * noise + 1)) -
+                                           noise
+                                     : 0);
+}
+
+/*
+ * Turn a sin/cos encoder through several periods in both directions, with
+ * steps of up to `max_step` units, and check the interpolated position
+ * against the actual position.
+ */
+TEST sweep(int amplitude, int hysteresis, int noise, long max_step,
+           long tolerance)
+{
+  enum
+  {
+    offset_a = 2048,
+    offset_b = 2000
+  };
+  long phase = random() % 65536;
+  encoder_interpolator ip;
+
+  encoder_interpolator_init(
+      &ip, offset_a, offset_b, hysteresis,
+      offset_a + (int)lround(amplitude * cos(two_pi * phase / 65536)),
+      offset_b + (int)lround(amplitude * sin(two_pi * phase / 65536)));
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    long const step = random() % (max_step + 1);
+    encoder_position_t pos;
+
+    phase += (i / 2500) % 2 ? -step : step;
+
+    pos = encoder_interpolator_update(
+        &ip, offset_a + noisy(amplitude * cos(two_pi * phase / 65536), noise),
+        offset_b + noisy(amplitude * sin(two_pi * phase / 65536), noise));
+
+    ASSERT_GTE(tolerance, labs(pos - phase));
+    ASSERT_GT(2L * 16384, labs(pos - ip.count * 16384));
+  }
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  srandom(42);
+
+  RUN_TEST(cordic_axes);
+  RUN_TESTp(cordic, 32767.0, 2);
+  RUN_TESTp(cordic, 2000.0, 2);
+  RUN_TESTp(cordic, 100.0, 2);
+
+  RUN_TESTp(sweep, 1500, 0, 0, 2000, 8);
+  RUN_TESTp(sweep, 1500, 50, 0, 2000, 8);
+  RUN_TESTp(sweep, 1500, 50, 20, 2000, 256);
+  RUN_TESTp(sweep, 200, 20, 10, 8000, 1024);
+
+  GREATEST_MAIN_END();
+}
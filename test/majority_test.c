@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/majority.h>
+
+enum
+{
+  WORDS = 200
+};
+
+typedef void (*init_func)(encoder_state*, encoder_fast_byte_t);
+
+typedef encoder_byte_t ENCODER_CONST_MEMORY (*table_type)[4];
+
+static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+
+static uint64_t samples[WORDS];
+
+/*
+ * Random walk along the gray code sequence, holding each position for up
+ * to `hold` samples, with a random sample replacing the actual one with a
+ * chance of 1 in `noise`.
+ */
+static void make_samples(int hold, int noise)
+{
+  unsigned pos = random() % 4;
+  int left = 0;
+
+  for (size_t i = 0; i < WORDS; ++i)
+  {
+    uint64_t w = 0;
+
+    for (unsigned k = 0; k < 64; k += 2)
+    {
+      uint64_t term;
+
+      if (left-- <= 0)
+      {
+        pos += random() % 3 - 1;
+        left = random() % hold;
+      }
+
+      term = random() % noise == 0 ? (uint64_t)(random() % 4) : gray[pos % 4];
+      w |= term << k;
+    }
+
+    samples[i] = w;
+  }
+}
+
+static unsigned sample(size_t i) { return samples[i / 32] >> 2 * (i % 32) & 3; }
+
+TEST filter(unsigned window, unsigned low, unsigned high)
+{
+  static uint64_t out[WORDS];
+  encoder_majority m;
+  unsigned const initial = random() % 4;
+  unsigned term = initial;
+  size_t const split = random() % WORDS;
+
+  encoder_majority_init_hysteresis(&m, window, low, high, initial);
+
+  /* filter in two parts, the second one in place */
+  encoder_majority_filter(&m, samples, out, split);
+  for (size_t i = split; i < WORDS; ++i)
+  {
+    out[i] = samples[i];
+  }
+  encoder_majority_filter(&m, &out[split], &out[split], WORDS - split);
+
+  for (size_t i = 0; i < 32 * WORDS; ++i)
+  {
+    for (unsigned c = 0; c < 2; ++c)
+    {
+      unsigned count = 0;
+
+      for (unsigned k = 0; k < window; ++k)
+      {
+        count += (k <= i ? sample(i - k) : initial) >> c & 1;
+      }
+
+      if (count >= high)
+      {
+        term |= 1u << c;
+      }
+      else if (count < low)
+      {
+        term &= ~(1u << c);
+      }
+    }
+
+    ASSERT_EQ_FMT(term, (unsigned)(out[i / 32] >> 2 * (i % 32) & 3), "%u");
+  }
+
+  ASSERT_EQ_FMT(term, (unsigned)m.terminal, "%u");
+
+  PASS();
+}
+
+TEST decode(unsigned window, init_func init, table_type table)
+{
+  static uint64_t filtered[WORDS];
+  uint64_t actions[2][WORDS];
+  encoder_majority m[2];
+  encoder_state s[2];
+  encoder_position_t delta[2];
+
+  encoder_majority_init(&m[0], window, samples[0] & 3);
+  m[1] = m[0];
+  init(&s[0], samples[0] & 3);
+  s[1] = s[0];
+
+  encoder_majority_filter(&m[0], samples, filtered, WORDS);
+  delta[0] = encoder_batch_update_tt(&s[0], filtered, actions[0], WORDS,
+                                     table);
+  delta[1] = encoder_majority_update_batch_tt(&m[1], &s[1], samples,
+                                              actions[1], WORDS, table);
+
+  ASSERT_EQ_FMT(delta[0], delta[1], "%ld");
+  ASSERT_EQ_FMT((int)s[0], (int)s[1], "%d");
+  ASSERT_MEM_EQ(actions[0], actions[1], sizeof(actions[0]));
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  srandom(42);
+
+  for (int i = 0; i < 5; ++i)
+  {
+    make_samples(40, 8);
+
+    RUN_TESTp(filter, 1, 1, 1);
+    RUN_TESTp(filter, 5, 3, 3);
+    RUN_TESTp(filter, 8, 3, 6);
+    RUN_TESTp(filter, 15, 8, 8);
+    RUN_TESTp(filter, 32, 17, 17);
+    RUN_TESTp(filter, 32, 0, 32);
+    RUN_TESTp(filter, 31, 10, 22);
+
+    make_samples(4, 2);
+
+    RUN_TESTp(filter, 7, 4, 4);
+    RUN_TESTp(filter, 16, 5, 12);
+
+    RUN_TESTp(decode, 9, encoder_debounced_half_step_init,
+              encoder_debounced_half_step_table);
+    RUN_TESTp(decode, 9, encoder_simple_quarter_step_init,
+              encoder_simple_quarter_step_table);
+  }
+
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/parallel.h>
+
+enum
+{
+  JOBS = 9
+};
+
+typedef void (*init_func)(encoder_state*, encoder_fast_byte_t);
+typedef encoder_byte_t ENCODER_CONST_MEMORY (*table_type)[4];
+
+static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+
+static void debounced_full_step_init(encoder_state* s,
+                                     encoder_fast_byte_t terminal)
+{
+  encoder_debounced_full_step_init(s, (encoder_byte_t)terminal);
+}
+
+/*
+ * A random walk of the inputs, with the occasional glitch, so that chunks
+ * speculatively decoded from the wrong state need to be resynchronised.
+ */
+static void walk(uint64_t* samples, size_t words, unsigned seed)
+{
+  unsigned pos = seed % 4;
+
+  for (size_t w = 0; w < words; ++w)
+  {
+    uint64_t word = 0;
+
+    for (unsigned i = 0; i < 32; ++i)
+    {
+      int const r = rand_r(&seed) % 16;
+
+      pos += r < 5 ? 1 : r < 9 ? 3 : r == 9 ? 2 : 0;
+      word |= (uint64_t)gray[pos % 4] << (2 * i);
+    }
+
+    samples[w] = word;
+  }
+}
+
+TEST decode(unsigned threads, size_t chunk_words, init_func init,
+            table_type table)
+{
+  static size_t const words[JOBS] = {0, 1, 63, 64, 65, 1000, 4097, 20000, 7};
+  encoder_parallel_job jobs[JOBS];
+  encoder_state states[JOBS], expected_states[JOBS];
+  uint64_t* samples[JOBS];
+  uint64_t* expected[JOBS];
+  encoder_parallel_stats stats;
+
+  for (size_t j = 0; j < JOBS; ++j)
+  {
+    samples[j] = malloc((words[j] + 1) * sizeof(uint64_t));
+    expected[j] = malloc((words[j] + 1) * sizeof(uint64_t));
+    walk(samples[j], words[j], (unsigned)j + 1);
+
+    init(&states[j], gray[j % 4]);
+    expected_states[j] = states[j];
+
+    jobs[j] = (encoder_parallel_job){
+        &states[j], samples[j],
+        j == 3 ? NULL : malloc((words[j] + 1) * sizeof(uint64_t)), words[j],
+        table, 0};
+  }
+
+  ASSERT_EQ(0, encoder_parallel_decode(jobs, JOBS, threads, chunk_words,
+                                       &stats));
+
+  for (size_t j = 0; j < JOBS; ++j)
+  {
+    encoder_position_t const delta = encoder_batch_update_tt(
+        &expected_states[j], samples[j], expected[j], words[j], table);
+
+    ASSERT_EQ_FMT(delta, jobs[j].delta, "%ld");
+    ASSERT_EQ(expected_states[j], states[j]);
+
+    if (jobs[j].actions)
+    {
+      ASSERT_MEM_EQ(expected[j], jobs[j].actions,
+                    words[j] * sizeof(uint64_t));
+    }
+
+    free(samples[j]);
+    free(expected[j]);
+    free(jobs[j].actions);
+  }
+
+  ASSERT_EQ((uint64_t)(1 + 63 + 64 + 65 + 1000 + 4097 + 20000 + 7) * 32,
+            stats.samples);
+  ASSERT(stats.resyncs <= stats.chunks);
+
+  PASS();
+}
+
+TEST empty(void)
+{
+  encoder_parallel_stats stats;
+
+  ASSERT_EQ(0, encoder_parallel_decode(NULL, 0, 4, 0, &stats));
+  ASSERT_EQ((size_t)0, stats.chunks);
+  ASSERT_EQ((uint64_t)0, stats.samples);
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TESTp(decode, 1, 0, encoder_simple_quarter_step_init,
+            encoder_simple_quarter_step_table);
+  RUN_TESTp(decode, 3, 64, encoder_simple_quarter_step_init,
+            encoder_simple_quarter_step_table);
+  RUN_TESTp(decode, 8, 100, encoder_simple_full_step_init,
+            encoder_simple_full_step_table);
+  RUN_TESTp(decode, 8, 1, debounced_full_step_init,
+            encoder_debounced_full_step_table);
+  RUN_TESTp(decode, 0, 0, encoder_simple_half_step_init,
+            encoder_simple_half_step_table);
+
+  RUN_TEST(empty);
+
+  GREATEST_MAIN_END();
+}
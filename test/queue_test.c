@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/queue.h>
+
+enum
+{
+  PRODUCERS = 4,
+  EVENTS = 100000
+};
+
+TEST backpressure(void)
+{
+  encoder_event_queue* q = encoder_event_queue_create(6);
+  encoder_event in[16], out[16];
+
+  ASSERT(q);
+  ASSERT_EQ((size_t)8, encoder_event_queue_capacity(q));
+
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    in[i] = (encoder_event){i, i % 3, ENCODER_ACTION_TURN_CW};
+  }
+
+  ASSERT_EQ((size_t)0, encoder_event_queue_pop(q, out, 16));
+
+  /* only as many events as there are free slots are accepted */
+  ASSERT_EQ((size_t)5, encoder_event_queue_push(q, in, 5));
+  ASSERT_EQ((size_t)3, encoder_event_queue_push(q, in + 5, 11));
+  ASSERT_EQ((size_t)0, encoder_event_queue_push(q, in + 8, 8));
+  ASSERT_FALSE(encoder_event_queue_push_action(q, 0, ENCODER_ACTION_TURN_CW,
+                                               0));
+  ASSERT(encoder_event_queue_push_action(q, 0, ENCODER_ACTION_NONE, 0));
+
+  ASSERT_EQ((size_t)3, encoder_event_queue_pop(q, out, 3));
+  ASSERT_EQ((size_t)3, encoder_event_queue_push(q, in + 8, 8));
+  ASSERT_EQ((size_t)8, encoder_event_queue_pop(q, out + 3, 16));
+
+  /* the queue has wrapped around */
+  for (uint32_t i = 0; i < 11; ++i)
+  {
+    ASSERT_EQ(in[i].timestamp, out[i].timestamp);
+    ASSERT_EQ(in[i].encoder, out[i].encoder);
+    ASSERT_EQ(in[i].action, out[i].action);
+  }
+
+  ASSERT(encoder_event_queue_push_action(q, 7, ENCODER_ACTION_TURN_CCW, 99));
+  ASSERT_EQ((size_t)1, encoder_event_queue_pop(q, out, 16));
+  ASSERT_EQ((uint64_t)99, out[0].timestamp);
+  ASSERT_EQ((uint32_t)7, out[0].encoder);
+  ASSERT_EQ((uint32_t)ENCODER_ACTION_TURN_CCW, out[0].action);
+
+  encoder_event_queue_destroy(q);
+
+  PASS();
+}
+
+struct producer
+{
+  encoder_event_queue* q;
+  uint32_t id;
+};
+
+/*
+ * Pushes EVENTS events with consecutive timestamps in random batches,
+ * retrying the rest of a batch whenever the queue is full.
+ */
+static void* produce(void* arg)
+{
+  struct producer const* p = arg;
+  unsigned seed = p->id;
+  encoder_event batch[32];
+  uint64_t next = 0;
+
+  while (next < EVENTS)
+  {
+    size_t size = 1 + rand_r(&seed) % 32;
+    size_t n = 0;
+
+    if (size > EVENTS - next)
+    {
+      size = EVENTS - next;
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+      batch[i] = (encoder_event){next + i, p->id,
+                                 1 + (uint32_t)((next + i) % 2)};
+    }
+
+    while (n < size)
+    {
+      size_t const pushed = encoder_event_queue_push(p->q, batch + n, size - n);
+
+      if (pushed == 0)
+      {
+        sched_yield();
+      }
+
+      n += pushed;
+    }
+
+    next += size;
+  }
+
+  return NULL;
+}
+
+TEST producers(size_t capacity)
+{
+  encoder_event_queue* q = encoder_event_queue_create(capacity);
+  struct producer p[PRODUCERS];
+  pthread_t thread[PRODUCERS];
+  uint64_t expected[PRODUCERS] = {0};
+  size_t received = 0;
+
+  ASSERT(q);
+
+  for (uint32_t i = 0; i < PRODUCERS; ++i)
+  {
+    p[i] = (struct producer){q, i};
+    ASSERT_EQ(0, pthread_create(&thread[i], NULL, produce, &p[i]));
+  }
+
+  while (received < (size_t)PRODUCERS * EVENTS)
+  {
+    encoder_event out[64];
+    size_t const n = encoder_event_queue_pop(q, out, 64);
+
+    if (n == 0)
+    {
+      sched_yield();
+    }
+
+    /* all events arrive exactly once and in order per producer */
+    for (size_t i = 0; i < n; ++i)
+    {
+      ASSERT(out[i].encoder < PRODUCERS);
+      ASSERT_EQ_FMT(expected[out[i].encoder], out[i].timestamp, "%lu");
+      ASSERT_EQ(1 + (uint32_t)(out[i].timestamp % 2), out[i].action);
+      ++expected[out[i].encoder];
+    }
+
+    received += n;
+  }
+
+  for (uint32_t i = 0; i < PRODUCERS; ++i)
+  {
+    ASSERT_EQ(0, pthread_join(thread[i], NULL));
+    ASSERT_EQ((uint64_t)EVENTS, expected[i]);
+  }
+
+  ASSERT_EQ((size_t)0, encoder_event_queue_pop(q, NULL, 0));
+
+  encoder_event_queue_destroy(q);
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TEST(backpressure);
+  RUN_TESTp(producers, 16);
+  RUN_TESTp(producers, 4096);
+
+  GREATEST_MAIN_END();
+}
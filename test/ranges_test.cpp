@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <ranges>
+#include <vector>
+
+#define GREATEST_VA_ARGS
+
+#include <greatest.h>
+
+#include <rotaryencoder/ranges.h>
+
+namespace
+{
+
+encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+
+/* a random walk with the occasional glitch */
+std::vector<encoder_byte_t> walk(std::size_t size)
+{
+  std::vector<encoder_byte_t> samples(size);
+  unsigned pos = 0;
+
+  for (auto& s : samples)
+  {
+    int const r = std::rand() % 16;
+    pos += r == 0 ? 1 : r == 1 ? 3 : 0;
+    s = r == 2 ? static_cast<encoder_byte_t>(std::rand() % 4) : gray[pos % 4];
+  }
+
+  return samples;
+}
+
+template <typename Encoder, typename Range>
+std::vector<enum encoder_action> reference(Range const& samples)
+{
+  std::vector<enum encoder_action> actions;
+  Encoder enc;
+  bool first = true;
+
+  for (auto s : samples)
+  {
+    if (first)
+    {
+      enc.init(s);
+      first = false;
+    }
+
+    actions.push_back(enc.update(s));
+  }
+
+  return actions;
+}
+
+template <typename Encoder, typename Range>
+bool check(Range&& samples, std::vector<enum encoder_action> const& expected)
+{
+  std::size_t i = 0;
+  encoder_position_t position = 0;
+
+  for (auto a : samples | rotaryencoder::views::decode<Encoder>())
+  {
+    if (i >= expected.size() || a != expected[i++])
+    {
+      return false;
+    }
+  }
+
+  if (i != expected.size())
+  {
+    return false;
+  }
+
+  i = 0;
+
+  for (auto const& s : samples | rotaryencoder::views::steps<Encoder>())
+  {
+    while (i < expected.size() && expected[i] == ENCODER_ACTION_NONE)
+    {
+      ++i;
+    }
+
+    position += expected[i] == ENCODER_ACTION_TURN_CW ? 1 : -1;
+
+    if (i >= expected.size() || s.index != i || s.action != expected[i] ||
+        s.position != position)
+    {
+      return false;
+    }
+
+    ++i;
+  }
+
+  while (i < expected.size() && expected[i] == ENCODER_ACTION_NONE)
+  {
+    ++i;
+  }
+
+  return i == expected.size();
+}
+
+}
+
+template <typename Encoder>
+TEST compare()
+{
+  static std::size_t const sizes[] = {0, 1, 31, 32, 33, 64, 1000, 4099};
+
+  for (auto size : sizes)
+  {
+    auto const samples = walk(size);
+    auto const expected = reference<Encoder>(samples);
+    std::list<encoder_byte_t> const list(samples.begin(), samples.end());
+    std::vector<int> const ints(samples.begin(), samples.end());
+
+    /* contiguous bytes, which `steps` decodes using the batch functions */
+    ASSERT(check<Encoder>(samples, expected));
+
+    /* generic forward and random access ranges */
+    ASSERT(check<Encoder>(list, expected));
+    ASSERT(check<Encoder>(ints, expected));
+    ASSERT(check<Encoder>(samples | std::views::transform([](auto s) {
+                            return static_cast<int>(s);
+                          }),
+                          expected));
+  }
+
+  PASS();
+}
+
+TEST compose()
+{
+  using encoder = rotaryencoder::simple_encoder_quarter_step_tt;
+  std::vector<encoder_byte_t> samples;
+
+  /* five steps clockwise, then three counter-clockwise */
+  for (unsigned pos = 0; pos < 5; ++pos)
+  {
+    samples.push_back(gray[pos % 4]);
+    samples.push_back(gray[pos % 4]);
+  }
+  for (unsigned pos = 5; pos > 1; --pos)
+  {
+    samples.push_back(gray[(pos - 1) % 4]);
+  }
+
+  auto ccw = samples | rotaryencoder::views::steps<encoder>() |
+             std::views::filter([](rotaryencoder::step const& s) {
+               return s.action == ENCODER_ACTION_TURN_CCW;
+             });
+  std::vector<rotaryencoder::step> steps;
+
+  std::ranges::copy(ccw, std::back_inserter(steps));
+
+  ASSERT_EQ(3u, steps.size());
+  ASSERT_EQ(11u, steps[0].index);
+  ASSERT_EQ(3, steps[0].position);
+  ASSERT_EQ(1, steps[2].position);
+
+  auto actions = samples | rotaryencoder::views::decode<encoder>();
+  ASSERT_EQ(samples.size(), actions.size());
+  ASSERT_EQ(4, std::ranges::count(actions, ENCODER_ACTION_TURN_CW));
+
+  /* decoding starts from scratch on every pass */
+  ASSERT_EQ(4, std::ranges::count(actions, ENCODER_ACTION_TURN_CW));
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  using namespace rotaryencoder;
+
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TEST(compare<simple_encoder_full_step_tt>);
+  RUN_TEST(compare<simple_encoder_half_step_tt>);
+  RUN_TEST(compare<simple_encoder_quarter_step_tt>);
+  RUN_TEST(compare<simple_encoder_quarter_step_imm>);
+  RUN_TEST(compare<debounced_encoder_full_step_tt>);
+  RUN_TEST(compare<debounced_encoder_full_step>);
+  RUN_TEST(compare<debounced_encoder_half_step_tt>);
+  RUN_TEST(compare<debounced_encoder_full_step_recovering_tt>);
+  RUN_TEST(compare<debounced_encoder_half_step_recovering_tt>);
+
+  RUN_TEST(compose);
+
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/registry.h>
+
+enum
+{
+  THREADS = 4,
+  ENCODERS = 37,
+  SAMPLES = 20000
+};
+
+static encoder_byte_t const gray[4] = {0x3, 0x2, 0x0, 0x1};
+
+TEST layout(size_t encoders, size_t shards, unsigned flags)
+{
+  encoder_registry* r = encoder_registry_create(encoders, shards, flags);
+  encoder_position_t* positions = malloc(encoders * sizeof(*positions));
+  size_t next = 0;
+
+  ASSERT(r);
+
+  for (size_t s = 0; s < shards; ++s)
+  {
+    encoder_registry_shard* shard = encoder_registry_get_shard(r, s);
+    size_t const size = encoder_registry_shard_size(shard);
+
+    ASSERT_EQ(next, encoder_registry_shard_first(shard));
+    ASSERT(size + 1 >= encoders / shards && size <= encoders / shards + 1);
+    ASSERT_EQ((uintptr_t)0, (uintptr_t)shard % 64);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+      uint64_t const samples = UINT64_C(0x4b4b4b4b4b4b4b4b);
+      encoder_state* state = encoder_registry_state(shard, i);
+
+      /* 32 quarter steps clockwise per word */
+      encoder_simple_quarter_step_init(state, gray[3]);
+      for (size_t k = 0; k < next + i; ++k)
+      {
+        encoder_registry_update_batch_tt(shard, i, &samples, NULL, 1,
+                                         encoder_simple_quarter_step_table);
+      }
+    }
+
+    next += size;
+  }
+
+  ASSERT_EQ(encoders, next);
+
+  /* all encoders are at a position unique to them */
+  for (size_t i = 0; i < encoders; ++i)
+  {
+    ASSERT_EQ_FMT((encoder_position_t)(i * 32), encoder_registry_position(r, i),
+                  "%ld");
+  }
+
+  ASSERT_EQ_FMT((encoder_position_t)(encoders * (encoders - 1) * 16),
+                encoder_registry_read(r, positions), "%ld");
+
+  for (size_t i = 0; i < encoders; ++i)
+  {
+    ASSERT_EQ_FMT((encoder_position_t)(i * 32), positions[i], "%ld");
+  }
+
+  free(positions);
+  encoder_registry_destroy(r);
+
+  PASS();
+}
+
+struct worker
+{
+  encoder_registry* r;
+  size_t shard;
+  encoder_position_t expected[ENCODERS];
+};
+
+static void* work(void* arg)
+{
+  struct worker* w = arg;
+  encoder_registry_shard* shard = encoder_registry_get_shard(w->r, w->shard);
+  size_t const first = encoder_registry_shard_first(shard);
+  size_t const size = encoder_registry_shard_size(shard);
+  unsigned seed = (unsigned)w->shard;
+  unsigned pos[ENCODERS] = {0};
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    encoder_simple_quarter_step_init(encoder_registry_state(shard, i),
+                                     gray[0]);
+  }
+
+  for (int k = 0; k < SAMPLES; ++k)
+  {
+    size_t const i = rand_r(&seed) % size;
+    int const dir = rand_r(&seed) % 3 - 1;
+
+    pos[i] += dir;
+    w->expected[first + i] += dir;
+    encoder_registry_update_tt(shard, i, gray[pos[i] % 4],
+                               encoder_simple_quarter_step_table);
+  }
+
+  return NULL;
+}
+
+TEST threads(unsigned flags)
+{
+  static struct worker workers[THREADS];
+  encoder_registry* r = encoder_registry_create(ENCODERS, THREADS, flags);
+  pthread_t thread[THREADS];
+  encoder_position_t positions[ENCODERS];
+
+  ASSERT(r);
+
+  for (size_t t = 0; t < THREADS; ++t)
+  {
+    workers[t] = (struct worker){r, t, {0}};
+    ASSERT_EQ(0, pthread_create(&thread[t], NULL, work, &workers[t]));
+  }
+
+  /* reading concurrently is allowed at any time */
+  for (int k = 0; k < 100; ++k)
+  {
+    encoder_registry_read(r, positions);
+  }
+
+  for (size_t t = 0; t < THREADS; ++t)
+  {
+    ASSERT_EQ(0, pthread_join(thread[t], NULL));
+  }
+
+  encoder_registry_read(r, positions);
+
+  for (size_t i = 0; i < ENCODERS; ++i)
+  {
+    encoder_position_t expected = 0;
+
+    for (size_t t = 0; t < THREADS; ++t)
+    {
+      expected += workers[t].expected[i];
+    }
+
+    ASSERT_EQ_FMT(expected, positions[i], "%ld");
+  }
+
+  encoder_registry_destroy(r);
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  RUN_TESTp(layout, 10, 3, 0);
+  RUN_TESTp(layout, 100, 7, ENCODER_REGISTRY_FIRST_TOUCH);
+  RUN_TESTp(layout, 5, 8, 0);
+  RUN_TESTp(layout, 1, 1, 0);
+
+  RUN_TESTp(threads, 0);
+  RUN_TESTp(threads, ENCODER_REGISTRY_FIRST_TOUCH);
+
+  GREATEST_MAIN_END();
+}
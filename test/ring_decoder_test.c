@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/debounced_encoder.h>
+#include <rotaryencoder/ring_decoder.h>
+#include <rotaryencoder/simple_encoder.h>
+
+typedef encoder_byte_t ENCODER_CONST_MEMORY (*table_type)[4];
+
+enum
+{
+  ENCODERS = 3,
+  RING_SIZE = 256
+};
+
+static encoder_byte_t const pins[ENCODERS][2] = {{0, 1}, {5, 3}, {15, 8}};
+
+/*
+ * Generates samples for ENCODERS randomly turned encoders and decodes them
+ * sample by sample for reference.
+ */
+struct generator
+{
+  table_type table;
+  unsigned pos[ENCODERS];
+  encoder_state state[ENCODERS];
+  encoder_position_t position[ENCODERS];
+};
+
+static encoder_fast_byte_t gray(unsigned pos)
+{
+  static encoder_byte_t const code[4] = {0x3, 0x2, 0x0, 0x1};
+  return code[pos % 4];
+}
+
+static void generator_init(struct generator* g, table_type table)
+{
+  g->table = table;
+
+  for (int i = 0; i < ENCODERS; ++i)
+  {
+    g->pos[i] = 0;
+    g->state[i] = 0x3;
+    g->position[i] = 0;
+  }
+}
+
+static encoder_ring_sample_t generator_next(struct generator* g)
+{
+  encoder_ring_sample_t sample = random() & 0xFFFF;
+
+  for (int i = 0; i < ENCODERS; ++i)
+  {
+    encoder_fast_byte_t term;
+
+    switch (random() % 8)
+    {
+    case 0:
+      ++g->pos[i];
+      break;
+    case 1:
+      --g->pos[i];
+      break;
+    default:
+      break;
+    }
+
+    term = gray(g->pos[i]);
+
+    sample &= ~(1u << pins[i][0] | 1u << pins[i][1]);
+    sample |= (term & 1) << pins[i][0] | (term >> 1) << pins[i][1];
+
+    switch (encoder_internal_update_tt(&g->state[i], term, g->table))
+    {
+    case ENCODER_ACTION_TURN_CW:
+      ++g->position[i];
+      break;
+    case ENCODER_ACTION_TURN_CCW:
+      --g->position[i];
+      break;
+    case ENCODER_ACTION_NONE:
+      break;
+    }
+  }
+
+  return sample;
+}
+
+static void setup(encoder_ring* ring, encoder_ring_encoder* enc,
+                  encoder_ring_sample_t const* buffer, table_type table)
+{
+  for (int i = 0; i < ENCODERS; ++i)
+  {
+    encoder_ring_encoder_init(&enc[i], pins[i][0], pins[i][1]);
+    enc[i].state = 0x3;
+  }
+
+  encoder_ring_init(ring, buffer, RING_SIZE, enc, ENCODERS, table);
+}
+
+TEST wraparound(table_type table)
+{
+  encoder_ring_sample_t buffer[RING_SIZE];
+  encoder_ring_encoder enc[ENCODERS];
+  encoder_ring ring;
+  struct generator g;
+  size_t head = 0;
+
+  generator_init(&g, table);
+  setup(&ring, enc, buffer, table);
+
+  ASSERT_EQ(0, encoder_ring_decode(&ring, 0));
+
+  for (int k = 0; k < 1000; ++k)
+  {
+    size_t n = random() % RING_SIZE;
+
+    while (n-- > 0)
+    {
+      buffer[head] = generator_next(&g);
+      head = (head + 1) % RING_SIZE;
+    }
+
+    encoder_ring_decode(&ring, random() % 2 && head == 0 ? RING_SIZE : head);
+
+    for (int i = 0; i < ENCODERS; ++i)
+    {
+      ASSERT_EQ_FMT(g.position[i], enc[i].position, "%ld");
+      ASSERT_EQ_FMT((int)g.state[i], (int)enc[i].state, "%d");
+    }
+  }
+
+  PASS();
+}
+
+/*
+ * Simulated circular DMA transfer, raising the half-transfer and
+ * transfer-complete "interrupts" after filling each half of the ring.
+ * Just like a real DMA, the producer doesn't wait for the consumer to
+ * decode a half before filling it, but for the test to be deterministic,
+ * it won't overwrite a half that hasn't been decoded yet.
+ */
+struct dma
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  unsigned produced;
+  unsigned consumed;
+  unsigned halves;
+  encoder_ring_sample_t buffer[RING_SIZE];
+  struct generator g;
+};
+
+static void* dma_producer(void* arg)
+{
+  struct dma* d = arg;
+
+  for (unsigned h = 0; h < d->halves; ++h)
+  {
+    encoder_ring_sample_t* half = &d->buffer[(h % 2) * (RING_SIZE / 2)];
+
+    pthread_mutex_lock(&d->mutex);
+    while (d->produced - d->consumed >= 2)
+    {
+      pthread_cond_wait(&d->cond, &d->mutex);
+    }
+    pthread_mutex_unlock(&d->mutex);
+
+    for (size_t i = 0; i < RING_SIZE / 2; ++i)
+    {
+      half[i] = generator_next(&d->g);
+    }
+
+    pthread_mutex_lock(&d->mutex);
+    ++d->produced;
+    pthread_cond_broadcast(&d->cond);
+    pthread_mutex_unlock(&d->mutex);
+  }
+
+  return NULL;
+}
+
+TEST dma(table_type table)
+{
+  static struct dma d;
+  encoder_ring_encoder enc[ENCODERS];
+  encoder_ring ring;
+  pthread_t producer;
+  unsigned actions = 0;
+
+  pthread_mutex_init(&d.mutex, NULL);
+  pthread_cond_init(&d.cond, NULL);
+  d.produced = d.consumed = 0;
+  d.halves = 2000;
+  generator_init(&d.g, table);
+  setup(&ring, enc, d.buffer, table);
+
+  ASSERT_EQ(0, pthread_create(&producer, NULL, dma_producer, &d));
+
+  while (d.consumed < d.halves)
+  {
+    pthread_mutex_lock(&d.mutex);
+    while (d.consumed == d.produced)
+    {
+      pthread_cond_wait(&d.cond, &d.mutex);
+    }
+    pthread_mutex_unlock(&d.mutex);
+
+    /* half-transfer or transfer-complete callback */
+    actions += encoder_ring_decode(&ring, d.consumed % 2 ? 0 : RING_SIZE / 2);
+
+    pthread_mutex_lock(&d.mutex);
+    ++d.consumed;
+    pthread_cond_broadcast(&d.cond);
+    pthread_mutex_unlock(&d.mutex);
+  }
+
+  pthread_join(producer, NULL);
+  pthread_cond_destroy(&d.cond);
+  pthread_mutex_destroy(&d.mutex);
+
+  ASSERT(actions > 0);
+
+  for (int i = 0; i < ENCODERS; ++i)
+  {
+    ASSERT_EQ_FMT(d.g.position[i], enc[i].position, "%ld");
+    ASSERT_EQ_FMT((int)d.g.state[i], (int)enc[i].state, "%d");
+  }
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  srandom(42);
+
+  RUN_TESTp(wraparound, encoder_debounced_full_step_table);
+  RUN_TESTp(wraparound, encoder_debounced_half_step_table);
+  RUN_TESTp(wraparound, encoder_simple_quarter_step_table);
+
+  RUN_TESTp(dma, encoder_debounced_half_step_table);
+  RUN_TESTp(dma, encoder_debounced_full_step_recovering_table);
+
+  GREATEST_MAIN_END();
+}
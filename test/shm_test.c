@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) Marcus Holland-Moritz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <greatest.h>
+
+#include <rotaryencoder/shm.h>
+
+enum
+{
+  ENCODERS = 40,
+  UPDATES = 200000
+};
+
+static char name[64];
+
+TEST publish(void)
+{
+  encoder_position_t in[ENCODERS], out[ENCODERS];
+  encoder_shm* writer = encoder_shm_create(name, ENCODERS);
+  encoder_shm* reader;
+
+  ASSERT(writer);
+  reader = encoder_shm_open(name);
+  ASSERT(reader);
+  ASSERT_EQ(ENCODERS, encoder_shm_count(reader));
+
+  ASSERT_EQ(0, encoder_shm_read(reader, 0, out, ENCODERS));
+  for (size_t i = 0; i < ENCODERS; ++i)
+  {
+    ASSERT_EQ(0, out[i]);
+    in[i] = (encoder_position_t)(i * 1000) - 12345;
+  }
+
+  /* a range that starts and ends in the middle of a cache line */
+  encoder_shm_publish(writer, 5, &in[5], 30);
+  encoder_shm_read(reader, 0, out, ENCODERS);
+  for (size_t i = 0; i < ENCODERS; ++i)
+  {
+    ASSERT_EQ_FMT(i >= 5 && i < 35 ? in[i] : 0, out[i], "%ld");
+  }
+
+  encoder_shm_read(reader, 33, out, 1);
+  ASSERT_EQ_FMT(in[33], out[0], "%ld");
+
+  encoder_shm_close(reader);
+  encoder_shm_close(writer);
+
+  ASSERT_EQ(0, encoder_shm_unlink(name));
+  ASSERT_EQ(NULL, encoder_shm_open(name));
+  ASSERT_EQ(ENOENT, errno);
+
+  PASS();
+}
+
+TEST invalid(void)
+{
+  int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+  ASSERT(fd >= 0);
+  ASSERT_EQ(0, ftruncate(fd, 4096));
+  close(fd);
+
+  ASSERT_EQ(NULL, encoder_shm_open(name));
+  ASSERT_EQ(EINVAL, errno);
+
+  ASSERT_EQ(0, encoder_shm_unlink(name));
+
+  PASS();
+}
+
+static atomic_int done;
+
+static void* write_positions(void* arg)
+{
+  encoder_shm* shm = arg;
+  encoder_position_t positions[ENCODERS];
+
+  for (encoder_position_t v = 1; v <= UPDATES; ++v)
+  {
+    for (size_t i = 0; i < ENCODERS; ++i)
+    {
+      positions[i] = v;
+    }
+
+    encoder_shm_publish(shm, 0, positions, ENCODERS);
+  }
+
+  atomic_store(&done, 1);
+
+  return NULL;
+}
+
+/*
+ * All positions are updated at once, so the positions in a cache line must
+ * always be equal, and must never go backwards.
+ */
+TEST concurrent(void)
+{
+  encoder_shm* writer = encoder_shm_create(name, ENCODERS);
+  encoder_shm* reader = encoder_shm_open(name);
+  encoder_position_t last[ENCODERS] = {0};
+  pthread_t thread;
+  int finished;
+
+  ASSERT(writer);
+  ASSERT(reader);
+
+  ASSERT_EQ(0, pthread_create(&thread, NULL, write_positions, writer));
+
+  do
+  {
+    encoder_position_t out[ENCODERS];
+
+    finished = atomic_load(&done);
+    encoder_shm_read(reader, 0, out, ENCODERS);
+
+    for (size_t i = 0; i < ENCODERS; ++i)
+    {
+      size_t const first = i - i % ENCODER_SHM_LINE_POSITIONS;
+
+      ASSERT_EQ_FMT(out[first], out[i], "%ld");
+      ASSERT_GTE(out[i], last[i]);
+      last[i] = out[i];
+    }
+  } while (!finished);
+
+  ASSERT_EQ(0, pthread_join(thread, NULL));
+
+  for (size_t i = 0; i < ENCODERS; ++i)
+  {
+    ASSERT_EQ_FMT((encoder_position_t)UPDATES, last[i], "%ld");
+  }
+
+  encoder_shm_close(reader);
+  encoder_shm_close(writer);
+  encoder_shm_unlink(name);
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+
+  snprintf(name, sizeof(name), "/rotaryencoder_shm_test.%ld", (long)getpid());
+
+  RUN_TEST(publish);
+  RUN_TEST(invalid);
+  RUN_TEST(concurrent);
+
+  GREATEST_MAIN_END();
+}